@@ -0,0 +1,177 @@
+#ifndef _ARCH_ATOMIC_H_
+#define _ARCH_ATOMIC_H_
+
+#include "ArchInterrupts.h"
+
+#if defined(__ARM_ARCH) && __ARM_ARCH >= 6
+#define ARCH_ATOMIC_LDREX 1
+#else
+#define ARCH_ATOMIC_LDREX 0
+#endif
+
+/**
+ * @class ArchAtomic
+ * The atomic operations behind Atomic (include Atomic.h instead of this file).
+ * ARMv6 (rpi) has the exclusive monitor: 32 bit values are changed by a ldrex/strex loop and
+ * only the orders other than MEMORY_ORDER_RELAXED pay for the data memory barrier, instead of
+ * the cache and TLB flush of memory_barrier() the ArchThreads functions use.
+ * The ARMv5 boards (integratorcp, verdex) have neither ldrex nor a barrier instruction, there
+ * and for 64 bit values keeping the interrupts away makes the operation atomic, there is only one core.
+ */
+class ArchAtomic
+{
+  public:
+    template<typename T>
+    static T load(const T& value, MemoryOrder order)
+    {
+      if (sizeof(T) != 4)
+      {
+        // a 64 bit value takes two loads, an interrupt in between could change its other half
+        bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+        T result = *(const volatile T*) &value;
+        if (interrupts_enabled)
+          ArchInterrupts::enableInterrupts();
+        return result;
+      }
+      T result = *(const volatile T*) &value;
+      if (order != MEMORY_ORDER_RELAXED)
+        barrier();
+      return result;
+    }
+
+    template<typename T>
+    static void store(T& target, T value, MemoryOrder order)
+    {
+      if (sizeof(T) != 4)
+      {
+        bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+        *(volatile T*) &target = value;
+        if (interrupts_enabled)
+          ArchInterrupts::enableInterrupts();
+        return;
+      }
+      if (order != MEMORY_ORDER_RELAXED)
+        barrier();
+      *(volatile T*) &target = value;
+      if (order == MEMORY_ORDER_SEQ_CST)
+        barrier();
+    }
+
+    template<typename T>
+    static T exchange(T& target, T value, MemoryOrder order)
+    {
+      T result;
+      before(order);
+#if ARCH_ATOMIC_LDREX
+      if (sizeof(T) == 4)
+      {
+        uint32 failed;
+        asm volatile("1: ldrex %[r], [%[t]]\n"
+                     "   strex %[f], %[v], [%[t]]\n"
+                     "   cmp %[f], #0\n"
+                     "   bne 1b"
+                     : [r]"=&r"(result), [f]"=&r"(failed) : [v]"r"(value), [t]"r"(&target) : "cc", "memory");
+      }
+      else
+#endif
+      {
+        bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+        result = *(volatile T*) &target;
+        *(volatile T*) &target = value;
+        if (interrupts_enabled)
+          ArchInterrupts::enableInterrupts();
+      }
+      after(order);
+      return result;
+    }
+
+    template<typename T>
+    static bool compareExchange(T& target, T& expected, T desired, MemoryOrder order)
+    {
+      T current;
+      before(order);
+#if ARCH_ATOMIC_LDREX
+      if (sizeof(T) == 4)
+      {
+        uint32 failed;
+        asm volatile("1: ldrex %[c], [%[t]]\n"
+                     "   mov %[f], #0\n"
+                     "   cmp %[c], %[e]\n"
+                     "   bne 2f\n"
+                     "   strex %[f], %[d], [%[t]]\n"
+                     "   cmp %[f], #0\n"
+                     "   bne 1b\n"
+                     "2:"
+                     : [c]"=&r"(current), [f]"=&r"(failed) : [e]"r"(expected), [d]"r"(desired), [t]"r"(&target) : "cc", "memory");
+      }
+      else
+#endif
+      {
+        bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+        current = *(volatile T*) &target;
+        if (current == expected)
+          *(volatile T*) &target = desired;
+        if (interrupts_enabled)
+          ArchInterrupts::enableInterrupts();
+      }
+      after(order);
+      if (current == expected)
+        return true;
+      expected = current;
+      return false;
+    }
+
+    template<typename T>
+    static T fetchAdd(T& target, T increment, MemoryOrder order)
+    {
+      T result;
+      before(order);
+#if ARCH_ATOMIC_LDREX
+      if (sizeof(T) == 4)
+      {
+        uint32 sum;
+        uint32 failed;
+        asm volatile("1: ldrex %[r], [%[t]]\n"
+                     "   add %[s], %[r], %[i]\n"
+                     "   strex %[f], %[s], [%[t]]\n"
+                     "   cmp %[f], #0\n"
+                     "   bne 1b"
+                     : [r]"=&r"(result), [s]"=&r"(sum), [f]"=&r"(failed) : [i]"r"(increment), [t]"r"(&target) : "cc", "memory");
+      }
+      else
+#endif
+      {
+        bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+        result = *(volatile T*) &target;
+        *(volatile T*) &target = result + increment;
+        if (interrupts_enabled)
+          ArchInterrupts::enableInterrupts();
+      }
+      after(order);
+      return result;
+    }
+
+  private:
+    static void barrier()
+    {
+#if ARCH_ATOMIC_LDREX
+      asm volatile("mcr p15, 0, %[z], c7, c10, 5" : : [z]"r"(0) : "memory");
+#else
+      asm volatile("" : : : "memory");
+#endif
+    }
+
+    static void before(MemoryOrder order)
+    {
+      if (order == MEMORY_ORDER_RELEASE || order == MEMORY_ORDER_ACQ_REL || order == MEMORY_ORDER_SEQ_CST)
+        barrier();
+    }
+
+    static void after(MemoryOrder order)
+    {
+      if (order == MEMORY_ORDER_ACQUIRE || order == MEMORY_ORDER_ACQ_REL || order == MEMORY_ORDER_SEQ_CST)
+        barrier();
+    }
+};
+
+#endif
@@ -17,6 +17,7 @@ class ArchBoardSpecific
     static void onIdle();
     static void enableTimer();
     static void disableTimer();
+    static uint32 getTimerFrequency();
     static void enableKBD();
     static void disableKBD();
     static void keyboard_irq_handler();
@@ -83,6 +83,16 @@ public:
  */
   static uint32 get_PPN_Of_VPN_In_KernelMapping(uint32 virtual_page, uint32 *physical_page, uint32 *physical_pte_page=0);
 
+/**
+ * Like get_PPN_Of_VPN_In_KernelMapping, but looks the virtual page up in this address space
+ * (including its user pages)
+ * @param virtual_page virtual Page to look up
+ * @param *physical_page Pointer to the result
+ * @return 0: if the virtual page doesn't map to any physical page\notherwise
+ * returns the page size in byte
+ */
+  uint32 get_PPN_Of_VPN(uint32 virtual_page, uint32 *physical_page);
+
   /**
    *
    * maps a virtual page to a physical page in kernel mapping
@@ -110,6 +120,19 @@ public:
   static const size_t RESERVED_START = 0x80000ULL;
   static const size_t RESERVED_END = 0x80400ULL;
 
+/**
+ * user space is mapped in 4KiB pages only here, see the x86_64 ArchMemory for huge pages
+ */
+  static const size_t HUGE_PAGE_SIZE = 0;
+  bool mapHugePage(uint32, uint32)
+  {
+    return false;
+  }
+  static size_t getHugePageMemory()
+  {
+    return 0;
+  }
+
 private:
 
 /** 
@@ -50,6 +50,14 @@ public:
  */
   static void initialise();
 
+/**
+ * deletes the info if not null
+ *
+ * @param info to be cleaned up
+ *
+ */
+  static void cleanupThreadInfos(ArchThreadInfo *&info);
+
 /**
  * creates the ArchThreadInfo for a kernel thread
  * @param info where the ArchThreadInfo is saved
@@ -85,6 +93,12 @@ public:
  */
   static void yield();
 
+/**
+ * tells the CPU that it is executing a busy waiting loop (pause on x86),
+ * to be called in each iteration of the loop
+ */
+  static void spinLoopHint();
+
 /**
  * sets a threads CR3 register to the given page dir / etc. defining its address space
  *
@@ -103,6 +117,16 @@ public:
  */
   static uint32 testSetLock(uint32 &lock, uint32 new_value);
 
+/**
+ * atomically replaces target with new_value if it still contains expected
+ *
+ * @param &target Reference to the variable being replaced
+ * @param expected the value target has to contain
+ * @param new_value to set target to
+ * @returns old value of target, the replacement happened iff it equals expected
+ */
+  static uint32 atomic_cmpxchg(uint32 &target, uint32 expected, uint32 new_value);
+
 /**
  * atomically increments or decrements value by increment
  *
@@ -120,6 +120,12 @@ void ArchCommon::idle()
   halt();
 }
 
+uint64 ArchCommon::getCycleCount()
+{
+  // no cycle counter in use, therefore the timer tick is never stopped on arm
+  return 0;
+}
+
 
 extern "C" void __aeabi_atexit()
 {
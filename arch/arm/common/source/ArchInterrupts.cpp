@@ -102,6 +102,11 @@ void ArchInterrupts::disableTimer()
   ArchBoardSpecific::disableTimer();
 }
 
+uint32 ArchInterrupts::getTimerFrequency()
+{
+  return ArchBoardSpecific::getTimerFrequency();
+}
+
 void ArchInterrupts::enableKBD()
 {
   ArchBoardSpecific::enableKBD();
@@ -160,7 +160,29 @@ ArchMemory::~ArchMemory()
       PageManager::instance()->freePPN(page_directory[pde_vpn].pt.pt_ppn - PHYS_OFFSET_4K);
     }
   }
-  PageManager::instance()->freePPN(page_dir_page_);
+  PageManager::instance()->freePPN(page_dir_page_, 4 * PAGE_SIZE);
+}
+
+uint32 ArchMemory::get_PPN_Of_VPN(uint32 virtual_page, uint32 *physical_page)
+{
+  PageDirEntry *page_directory = (PageDirEntry *) getIdentAddressOfPPN(page_dir_page_);
+  uint32 pde_vpn = virtual_page / PAGE_TABLE_ENTRIES;
+  uint32 pte_vpn = virtual_page % PAGE_TABLE_ENTRIES;
+  if (page_directory[pde_vpn].page.size == PDE_SIZE_PAGE) // 1m page
+  {
+    *physical_page = page_directory[pde_vpn].page.page_ppn - PHYS_OFFSET_1M;
+    return 1024 * 1024;
+  }
+  else if (page_directory[pde_vpn].pt.size == PDE_SIZE_PT) // 4k page
+  {
+    PageTableEntry *pte_base = ((PageTableEntry *) getIdentAddressOfPPN(page_directory[pde_vpn].pt.pt_ppn - PHYS_OFFSET_4K)) + page_directory[pde_vpn].pt.offset * PAGE_TABLE_ENTRIES;
+    if (pte_base[pte_vpn].size == 2)
+    {
+      *physical_page = pte_base[pte_vpn].page_ppn - PHYS_OFFSET_4K;
+      return PAGE_SIZE;
+    }
+  }
+  return 0;
 }
 
 bool ArchMemory::checkAddressValid(uint32 vaddress_to_check)
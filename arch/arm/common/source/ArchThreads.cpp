@@ -4,6 +4,7 @@
  */
 
 #include "ArchThreads.h"
+#include "SlabAllocator.h"
 #include "ArchMemory.h"
 #include "kprintf.h"
 #include "paging-definitions.h"
@@ -11,19 +12,34 @@
 #include "Thread.h"
 #include "Scheduler.h"
 #include "SpinLock.h"
+#include "ArchInterrupts.h"
 
 SpinLock global_atomic_add_lock("");
 
 extern PageDirEntry kernel_page_directory[];
 
+static SlabCache* thread_info_cache;
+
+static ArchThreadInfo* allocateThreadInfo()
+{
+  return (ArchThreadInfo*) SlabAllocator::instance()->getCache(thread_info_cache, "ArchThreadInfo",
+                                                               sizeof(ArchThreadInfo))->allocate(sizeof(ArchThreadInfo));
+}
+
 void ArchThreads::initialise()
 {
   new (&global_atomic_add_lock) SpinLock("global_atomic_add_lock");
-  currentThreadInfo = (ArchThreadInfo*) new uint8[sizeof(ArchThreadInfo)];
+  currentThreadInfo = allocateThreadInfo();
   pointer pageDirectory = VIRTUAL_TO_PHYSICAL_BOOT(((pointer)kernel_page_directory));
   currentThreadInfo->ttbr0 = pageDirectory;
 }
 
+void ArchThreads::cleanupThreadInfos(ArchThreadInfo *&info)
+{
+  thread_info_cache->free(info, sizeof(ArchThreadInfo));
+  info = 0;
+}
+
 void ArchThreads::setAddressSpace(Thread *thread, ArchMemory& arch_memory)
 {
   assert(arch_memory.page_dir_page_ != 0);
@@ -35,7 +51,7 @@ void ArchThreads::setAddressSpace(Thread *thread, ArchMemory& arch_memory)
 
 void ArchThreads::createThreadInfosKernelThread(ArchThreadInfo *&info, pointer start_function, pointer stack)
 {
-  info = (ArchThreadInfo*)new uint8[sizeof(ArchThreadInfo)];
+  info = allocateThreadInfo();
   memset((void*)info, 0, sizeof(ArchThreadInfo));
   pointer pageDirectory = VIRTUAL_TO_PHYSICAL_BOOT(((pointer)kernel_page_directory));
   assert((pageDirectory) != 0);
@@ -59,7 +75,7 @@ void ArchThreads::changeInstructionPointer(ArchThreadInfo *info, pointer functio
 
 void ArchThreads::createThreadInfosUserspaceThread(ArchThreadInfo *&info, pointer start_function, pointer user_stack, pointer kernel_stack)
 {
-  info = (ArchThreadInfo*)new uint8[sizeof(ArchThreadInfo)];
+  info = allocateThreadInfo();
   memset((void*)info, 0, sizeof(ArchThreadInfo));
   pointer pageDirectory = VIRTUAL_TO_PHYSICAL_BOOT(((pointer)kernel_page_directory));
   assert((pageDirectory) != 0);
@@ -81,6 +97,12 @@ void ArchThreads::yield()
   asm("swi #0xffff");
 }
 
+void ArchThreads::spinLoopHint()
+{
+  // the cores supported so far have no hint instruction
+  asm volatile("nop");
+}
+
 extern "C" void memory_barrier();
 extern "C" uint32 arch_TestAndSet(uint32, uint32, uint32 new_value, uint32 *lock);
 uint32 ArchThreads::testSetLock(uint32 &lock, uint32 new_value)
@@ -92,6 +114,20 @@ uint32 ArchThreads::testSetLock(uint32 &lock, uint32 new_value)
   return result;
 }
 
+uint32 ArchThreads::atomic_cmpxchg(uint32 &target, uint32 expected, uint32 new_value)
+{
+  // there is only one core, keeping the interrupts away makes it atomic
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  memory_barrier();
+  uint32 result = target;
+  if (result == expected)
+    target = new_value;
+  memory_barrier();
+  if (interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
+  return result;
+}
+
 extern "C" uint32 arch_atomic_add(uint32, uint32, uint32 increment, uint32 *value);
 uint32 ArchThreads::atomic_add(uint32 &value, int32 increment)
 {
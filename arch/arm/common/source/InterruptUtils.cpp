@@ -130,7 +130,7 @@ void arch_swi_irq_handler()
 
   if (swi == 0xffff) // yield
   {
-    Scheduler::instance()->schedule();
+    Scheduler::instance()->schedule(true);
   }
   else if (swi == 0x0) // syscall
   {
@@ -83,6 +83,12 @@ void ArchBoardSpecific::disableTimer()
   t0mmio[REG_CTRL] = 0;
 }
 
+uint32 ArchBoardSpecific::getTimerFrequency()
+{
+  // timer 0 counts down 0x2fffff at the 40 MHz system clock
+  return 12716;
+}
+
 extern struct KMI* kmi;
 
 void ArchBoardSpecific::enableKBD()
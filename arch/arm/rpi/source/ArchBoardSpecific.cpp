@@ -115,6 +115,12 @@ void ArchBoardSpecific::disableTimer()
   //uint32* timer_control = (uint32*)0x9000B40C;
 }
 
+uint32 ArchBoardSpecific::getTimerFrequency()
+{
+  // 250 MHz APB clock / 126 (default pre-divider) / 16 (prescaler) / 0x800
+  return 60547;
+}
+
 void ArchBoardSpecific::enableKBD()
 {
 
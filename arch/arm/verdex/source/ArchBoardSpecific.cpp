@@ -76,6 +76,12 @@ void ArchBoardSpecific::disableTimer()
   *oeir &= ~1;
 }
 
+uint32 ArchBoardSpecific::getTimerFrequency()
+{
+  // OSMR0 match every 200000 cycles of the 3.6864 MHz OS timer
+  return 18432;
+}
+
 
 void ArchBoardSpecific::enableKBD()
 {
@@ -87,6 +87,12 @@ class ArchCommon
      */
     static void idle();
 
+    /**
+     * @return the value of the CPU's cycle counter (the time stamp counter on x86),
+     * 0 if the architecture has none
+     */
+    static uint64 getCycleCount();
+
     /**
      * draw a heartbeat character
      */
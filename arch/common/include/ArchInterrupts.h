@@ -54,6 +54,12 @@ public:
    */
   static void disableTimer();
 
+  /**
+   * @return the (approximate) rate of the timer interrupt in mHz,
+   * used to convert times to timer ticks (the x86 PIT runs at 18.2 Hz)
+   */
+  static uint32 getTimerFrequency();
+
   /**
    * enables the Keyboard IRQ (1)
    *
@@ -1,7 +1,7 @@
 #ifndef _BD_DEVICE_MANAGER_
 #define _BD_DEVICE_MANAGER_
 
-#include <ulist.h>
+#include "RCUList.h"
 
 class BDRequest;
 class BDVirtualDevice;
@@ -67,7 +67,11 @@ class BDManager
      */
     bool probeIRQ;
 
-    ustl::list<BDVirtualDevice *> device_list_;
+    /**
+     * the devices, indexed by their device number, read without a lock (also by serviceIRQ)
+     * devices are only added during the device detection, so there are no concurrent writers
+     */
+    RCUList<BDVirtualDevice *> device_list_;
 
   protected:
     static BDManager *instance_;
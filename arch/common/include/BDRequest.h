@@ -6,15 +6,12 @@
  *
  * Create the BDRequest object with the proper parameters,
  * pass the instance of that object to the pleaseProcessRequest
- * method of the BDManager and go to sleep.
- * The calling thread will be awaken when the command is
- * processed. No timeouts are implemented so if there is some
- * communication error between the BDManager and the drivers,
- * the thread will be sleeping for a looooong looong time.
- * Possible solution is to implement timeout in sleep in
- * scheduler.
- * The second option is to make a busy wait and check the
- * getStatus() method.
+ * method of the BDManager and wait on getWaitQueue() until
+ * getStatus() is not BD_QUEUED any longer (check the status
+ * with interrupts disabled, see WaitQueue).
+ * The waiting threads are woken up by setStatus() when the
+ * command is processed. Use a timeout in case there is some
+ * communication error between the BDManager and the drivers.
  * Look at the BD_CMD enum for the list of possible commands.
  *
  */
@@ -23,11 +20,17 @@
 #define _BD_REQUEST_H_
 
 #include "types.h"
+#include "WaitQueue.h"
 
 class Thread;
 
 extern Thread * currentThread;
 
+/**
+ * a request not processed within this time is given up
+ */
+#define BD_REQUEST_TIMEOUT_SECONDS 5
+
 class BDRequest
 {
   protected:
@@ -77,7 +80,8 @@ class BDRequest
      * checks performed, possible pagefault here
      *
      */
-    BDRequest( uint32 dev_id, BD_CMD cmd, uint32 start_block = 0, uint32 num_block = 0, void * buffer = 0 ) 
+    BDRequest( uint32 dev_id, BD_CMD cmd, uint32 start_block = 0, uint32 num_block = 0, void * buffer = 0 ) :
+      wait_queue_("BDRequest::wait_queue_")
     {
       num_block_=num_block;
       start_block_=start_block;
@@ -166,10 +170,22 @@ class BDRequest
     void setResult( uint32 result ){ result_=result; };
 
     /**
-     * sets the status of this request
+     * sets the status of this request, wakes up the threads waiting
+     * for it in case it is not BD_QUEUED any longer
+     *
+     */
+    void setStatus( BD_RESULT status )
+    {
+      status_=status;
+      if( status != BD_QUEUED )
+        wait_queue_.wakeAll();
+    };
+
+    /**
+     * returns the queue the threads waiting for the request sleep on
      *
      */
-    void setStatus( BD_RESULT status ){ status_=status; };
+    WaitQueue &getWaitQueue(){ return wait_queue_; };
 
     /**
      * sets the the number of the blocks already read/written \sa getBlocksDone
@@ -218,6 +234,8 @@ class BDRequest
     Thread *requesting_thread_;
     /// next_request in the linked list
     BDRequest *next_request_;
+    /// Threads waiting for the request to be processed
+    WaitQueue wait_queue_;
 };
 
 #endif
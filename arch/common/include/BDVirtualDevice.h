@@ -89,6 +89,14 @@ class BDVirtualDevice
 
   private:
     BDVirtualDevice();
+
+    /**
+     * sleeps until the driver processed the request (if it works with interrupts)
+     * or BD_REQUEST_TIMEOUT_SECONDS passed
+     * @param request the request added before
+     */
+    void waitForRequest(BDRequest *request);
+
     uint32 dev_number_;
     uint32 offset_;
     uint32 num_sectors_;
@@ -11,6 +11,7 @@
 #include "kprintf.h"
 #include "debug.h"
 #include "kstring.h"
+#include "RCU.h"
 
 BDManager *BDManager::getInstance()
 {
@@ -45,7 +46,7 @@ void BDManager::addVirtualDevice(BDVirtualDevice* dev)
 {
   debug(BD_MANAGER, "addVirtualDevice:Adding device\n");
   dev->setDeviceNumber(device_list_.size());
-  device_list_.push_back(dev);
+  device_list_.pushBack(dev);
   debug(BD_MANAGER, "addVirtualDevice:Device added\n");
 }
 
@@ -54,7 +55,8 @@ void BDManager::serviceIRQ(uint32 irq_num)
   debug(BD_MANAGER, "serviceIRQ:Servicing IRQ\n");
   probeIRQ = false;
 
-  for (BDVirtualDevice* dev : device_list_)
+  RCUReadLock rl;
+  for (BDVirtualDevice* dev : device_list_.read())
     if (dev->getDriver()->irq == irq_num)
     {
       dev->getDriver()->serviceIRQ();
@@ -66,13 +68,20 @@ void BDManager::serviceIRQ(uint32 irq_num)
 
 BDVirtualDevice* BDManager::getDeviceByNumber(uint32 dev_num)
 {
-  return device_list_[dev_num];
+  RCUReadLock rl;
+  for (BDVirtualDevice* dev : device_list_.read())
+  {
+    if (dev->getDeviceNumber() == dev_num)
+      return dev;
+  }
+  return 0;
 }
 
 BDVirtualDevice* BDManager::getDeviceByName(const char * dev_name)
 {
   debug(BD_MANAGER, "getDeviceByName: %s", dev_name);
-  for (BDVirtualDevice* dev : device_list_)
+  RCUReadLock rl;
+  for (BDVirtualDevice* dev : device_list_.read())
   {
     if (strcmp(dev->getName(), dev_name) == 0)
     {
@@ -85,6 +94,7 @@ BDVirtualDevice* BDManager::getDeviceByName(const char * dev_name)
 
 uint32 BDManager::getNumberOfDevices(void)
 {
+  RCUReadLock rl;
   return device_list_.size();
 }
 
@@ -44,30 +44,40 @@ void BDVirtualDevice::addRequest(BDRequest * command)
 }
 ;
 
+void BDVirtualDevice::waitForRequest(BDRequest * request)
+{
+  if (driver_->irq == 0)
+    return;
+
+  size_t timeout_ticks = ArchInterrupts::getTimerFrequency() * BD_REQUEST_TIMEOUT_SECONDS / 1000 + 1;
+  uint32 jiffies = 0;
+  // the status is set by the interrupt handler, checking it with interrupts disabled ensures
+  // that the wake up cannot happen between the check and going to sleep
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  // before the scheduler runs the wait returns at once, the jiffies limit the polling then
+  while (request->getStatus() == BDRequest::BD_QUEUED && jiffies++ < IO_TIMEOUT)
+  {
+    if (!request->getWaitQueue().waitWithTimeout(timeout_ticks))
+      break;
+  }
+  if (interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
+}
+
 int32 BDVirtualDevice::readData(uint32 offset, uint32 size, char *buffer)
 {
   assert(buffer);
   assert(offset % block_size_ == 0 && "we can only read multiples of block_size_ from the device");
   assert(size % block_size_ == 0 && "we can only read multiples of block_size_ from the device");
   debug(BD_VIRT_DEVICE, "readData\n");
-  uint32 blocks2read = size / block_size_, jiffies = 0;
+  uint32 blocks2read = size / block_size_;
   uint32 blockoffset = offset / block_size_;
 
   debug(BD_VIRT_DEVICE, "blocks2read %d\n", blocks2read);
   BDRequest bd(dev_number_, BDRequest::BD_READ, blockoffset, blocks2read, buffer);
   addRequest(&bd);
 
-  if (driver_->irq != 0)
-  {
-    bool interrupt_context = ArchInterrupts::disableInterrupts();
-    ArchInterrupts::enableInterrupts();
-
-    while (bd.getStatus() == BDRequest::BD_QUEUED && jiffies++ < IO_TIMEOUT)
-      ArchInterrupts::yieldIfIFSet();
-
-    if (!interrupt_context)
-      ArchInterrupts::disableInterrupts();
-  }
+  waitForRequest(&bd);
 
   if (bd.getStatus() != BDRequest::BD_DONE)
   {
@@ -82,23 +92,13 @@ int32 BDVirtualDevice::writeData(uint32 offset, uint32 size, char *buffer)
   assert(offset % block_size_ == 0 && "we can only write multiples of block_size_ to the device");
   assert(size % block_size_ == 0 && "we can only write multiples of block_size_ to the device");
   debug(BD_VIRT_DEVICE, "writeData\n");
-  uint32 blocks2write = size / block_size_, jiffies = 0;
+  uint32 blocks2write = size / block_size_;
   uint32 blockoffset = offset / block_size_;
 
   BDRequest bd(dev_number_, BDRequest::BD_WRITE, blockoffset, blocks2write, buffer);
   addRequest(&bd);
 
-  if (driver_->irq != 0)
-  {
-    bool interrupt_context = ArchInterrupts::disableInterrupts();
-    ArchInterrupts::enableInterrupts();
-
-    while (bd.getStatus() == BDRequest::BD_QUEUED && jiffies++ < IO_TIMEOUT)
-      ArchInterrupts::yieldIfIFSet();
-
-    if (!interrupt_context)
-      ArchInterrupts::disableInterrupts();
-  }
+  waitForRequest(&bd);
 
   if (bd.getStatus() != BDRequest::BD_DONE)
     return -1;
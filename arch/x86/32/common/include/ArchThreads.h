@@ -32,7 +32,7 @@ struct ArchThreadInfo
   uint32  esp0;      // 68
   uint32  ss0;       // 72
   uint32  cr3;       // 76
-  uint32  fpu[27];   // 80
+  uint8*  fpu_state; // 80, see ArchFpu
 };
 
 class Thread;
@@ -108,6 +108,12 @@ public:
  */
   static void yield();
 
+/**
+ * tells the CPU that it is executing a busy waiting loop (pause on x86),
+ * to be called in each iteration of the loop
+ */
+  static void spinLoopHint();
+
 /**
  * sets a threads CR3 register to the given page dir / etc. defining its address space
  *
@@ -134,6 +140,16 @@ public:
  */
   static uint32 testSetLock(uint32 &lock, uint32 new_value);
 
+/**
+ * atomically replaces target with new_value if it still contains expected
+ *
+ * @param &target Reference to the variable being replaced
+ * @param expected the value target has to contain
+ * @param new_value to set target to
+ * @returns old value of target, the replacement happened iff it equals expected
+ */
+  static uint32 atomic_cmpxchg(uint32 &target, uint32 expected, uint32 new_value);
+
 /**
  * atomically increments or decrements value by increment
  *
@@ -32,15 +32,16 @@ typedef uint32 gid_t;
 #define Min(x,y) (((x)<(y))?(x):(y))
 #define Max(x,y) (((x)>(y))?(x):(y))
 
-#define KERNEL_CS  (8*3)
-#define KERNEL_DS  (8*2)
-#define KERNEL_SS  (8*2)
+// SYSENTER/SYSEXIT expect the kernel code, kernel data, user code and user data segments in this order
+#define KERNEL_CS  (8*2)
+#define KERNEL_DS  (8*3)
+#define KERNEL_SS  (8*3)
 #define KERNEL_TSS (8*6)
 #define DPL_KERNEL  0
 #define DPL_USER    3
-#define USER_CS ((8*5)|DPL_USER)
-#define USER_DS ((8*4)|DPL_USER)
-#define USER_SS ((8*4)|DPL_USER)
+#define USER_CS ((8*4)|DPL_USER)
+#define USER_DS ((8*5)|DPL_USER)
+#define USER_SS ((8*5)|DPL_USER)
 
 #define likely(x)       __builtin_expect((x),1)
 #define unlikely(x)     __builtin_expect((x),0)
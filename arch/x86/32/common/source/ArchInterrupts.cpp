@@ -9,6 +9,7 @@
 #include "InterruptUtils.h"
 #include "SegmentUtils.h"
 #include "ArchThreads.h"
+#include "ArchFpu.h"
 #include "assert.h"
 #include "Thread.h"
 
@@ -32,6 +33,12 @@ void ArchInterrupts::disableTimer()
   disableIRQ(0);
 }
 
+uint32 ArchInterrupts::getTimerFrequency()
+{
+  // the PIT is left at the BIOS default: 1193182 Hz / 65536
+  return 18206;
+}
+
 void ArchInterrupts::enableKBD()
 {
   enableIRQ(1);
@@ -123,11 +130,6 @@ extern "C" void arch_saveThreadRegisters(uint32 error)
   register struct interrupt_registers* iregisters;
   iregisters = (struct interrupt_registers*) (&error + 2 + sizeof(struct context_switch_registers)/sizeof(uint32) + (error));
   register ArchThreadInfo* info = currentThreadInfo;
-  asm("fnsave %[fpu]\n"
-      "frstor %[fpu]\n"
-      :
-      : [fpu]"m"((info->fpu))
-      :);
   if (iregisters->cs & 0x3)
   {
     info->ss = iregisters->ss3;
@@ -168,7 +170,7 @@ extern "C" void arch_contextSwitch()
     asm("mov %[esp], %%esp\n" : : [esp]"m"(info.esp));
   }
   g_tss->esp0 = info.esp0;
-  asm("frstor %[fpu]\n" : : [fpu]"m"(info.fpu));
+  ArchFpu::switchTo(currentThreadInfo);
   asm("mov %[cr3], %%cr3\n" : : [cr3]"r"(info.cr3));
   asm("push %[eflags]\n" : : [eflags]"m"(info.eflags));
   asm("push %[cs]\n" : : [cs]"m"(info.cs));
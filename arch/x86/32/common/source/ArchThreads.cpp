@@ -1,16 +1,35 @@
 #include "ArchThreads.h"
+#include "SlabAllocator.h"
 #include "ArchMemory.h"
+#include "ArchFpu.h"
 #include "kprintf.h"
 #include "paging-definitions.h"
 #include "offsets.h"
 #include "Thread.h"
 #include "kstring.h"
 
+static SlabCache* thread_info_cache;
 
+static ArchThreadInfo* allocateThreadInfo()
+{
+  return (ArchThreadInfo*) SlabAllocator::instance()->getCache(thread_info_cache, "ArchThreadInfo",
+                                                               sizeof(ArchThreadInfo))->allocate(sizeof(ArchThreadInfo));
+}
 
 void ArchThreads::initialise()
 {
-  currentThreadInfo = (ArchThreadInfo*) new uint8[sizeof(ArchThreadInfo)];
+  currentThreadInfo = allocateThreadInfo();
+  memset((void*)currentThreadInfo, 0, sizeof(ArchThreadInfo));
+  ArchFpu::initialise();
+}
+
+void ArchThreads::cleanupThreadInfos(ArchThreadInfo *&info)
+{
+  if (!info)
+    return;
+  ArchFpu::destroyState(info);
+  thread_info_cache->free(info, sizeof(ArchThreadInfo));
+  info = 0;
 }
 
 void ArchThreads::setAddressSpace(Thread *thread, ArchMemory& arch_memory)
@@ -22,7 +41,7 @@ void ArchThreads::setAddressSpace(Thread *thread, ArchMemory& arch_memory)
 
 void ArchThreads::createThreadInfosKernelThread(ArchThreadInfo *&info, pointer start_function, pointer stack)
 {
-  info = (ArchThreadInfo*)new uint8[sizeof(ArchThreadInfo)];
+  info = allocateThreadInfo();
   memset((void*)info, 0, sizeof(ArchThreadInfo));
   pointer root_of_kernel_paging_structure = VIRTUAL_TO_PHYSICAL_BOOT(((pointer)ArchMemory::getRootOfKernelPagingStructure()));
 
@@ -37,14 +56,7 @@ void ArchThreads::createThreadInfosKernelThread(ArchThreadInfo *&info, pointer s
   info->eip     = start_function;
   info->cr3     = root_of_kernel_paging_structure;
 
- /* fpu (=fninit) */
-  info->fpu[0] = 0xFFFF037F;
-  info->fpu[1] = 0xFFFF0000;
-  info->fpu[2] = 0xFFFFFFFF;
-  info->fpu[3] = 0x00000000;
-  info->fpu[4] = 0x00000000;
-  info->fpu[5] = 0x00000000;
-  info->fpu[6] = 0xFFFF0000;
+  ArchFpu::createState(info);
 }
 
 void ArchThreads::createThreadInfosUserspaceThread(ArchThreadInfo *&info, pointer start_function, pointer user_stack, pointer kernel_stack)
@@ -70,11 +82,21 @@ void ArchThreads::yield()
   asm("int $65");
 }
 
+void ArchThreads::spinLoopHint()
+{
+  asm volatile("pause");
+}
+
 uint32 ArchThreads::testSetLock(uint32 &lock, uint32 new_value)
 {
   return __sync_lock_test_and_set(&lock,new_value);
 }
 
+uint32 ArchThreads::atomic_cmpxchg(uint32 &target, uint32 expected, uint32 new_value)
+{
+  return __sync_val_compare_and_swap(&target, expected, new_value);
+}
+
 uint32 ArchThreads::atomic_add(uint32 &value, int32 increment)
 {
   return __sync_fetch_and_add(&value,increment);
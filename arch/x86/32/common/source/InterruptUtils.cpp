@@ -3,7 +3,9 @@
 #include "ArchSerialInfo.h"
 #include "BDManager.h"
 #include "ArchMemory.h"
+#include "SegmentUtils.h"
 #include "ArchThreads.h"
+#include "ArchFpu.h"
 #include "ArchCommon.h"
 #include "kprintf.h"
 #include "Scheduler.h"
@@ -18,6 +20,7 @@
 #include "Loader.h"
 #include "Syscall.h"
 #include "paging-definitions.h"
+#include "assert.h"
 
 #define LO_WORD(x) (((uint32)(x)) & 0x0000FFFF)
 #define HI_WORD(x) ((((uint32)(x)) >> 16) & 0x0000FFFF)
@@ -33,6 +36,11 @@
 
 #define SYSCALL_INTERRUPT 0x80 // number of syscall interrupt
 
+#define MSR_SYSENTER_CS  0x174
+#define MSR_SYSENTER_ESP 0x175
+#define MSR_SYSENTER_EIP 0x176
+#define CPUID_FEATURE_SEP (1 << 11)
+
 
 // --- Pagefault error flags.
 //     PF because/in/caused by/...
@@ -99,6 +107,7 @@ void InterruptUtils::initialise()
   idtr.base = (uint32) interrupt_gates;
   idtr.limit = sizeof(GateDesc) * num_handlers - 1;
   lidt(&idtr);
+  initialiseFastSyscalls();
 }
 
 void InterruptUtils::lidt(IDTR *idtr)
@@ -106,6 +115,30 @@ void InterruptUtils::lidt(IDTR *idtr)
   asm volatile("lidt (%0) ": :"q" (idtr));
 }
 
+static void wrmsr(uint32 msr, uint32 value)
+{
+  asm volatile("wrmsr" : : "c"(msr), "a"(value), "d"(0));
+}
+
+extern TSS *g_tss;
+extern "C" void arch_fastSyscallHandler();
+
+void InterruptUtils::initialiseFastSyscalls()
+{
+  uint32 eax = 1, ebx, ecx, edx;
+  asm volatile("cpuid" : "+a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx));
+  if (!(edx & CPUID_FEATURE_SEP))
+  {
+    debug(A_INTERRUPTS, "CPU does not support SYSENTER, only int 0x80 is available for syscalls\n");
+    return;
+  }
+  assert(g_tss);
+  wrmsr(MSR_SYSENTER_CS, KERNEL_CS);
+  // the entry code loads the kernel stack of the current thread from there
+  wrmsr(MSR_SYSENTER_ESP, (uint32) &g_tss->esp0);
+  wrmsr(MSR_SYSENTER_EIP, (uint32) arch_fastSyscallHandler);
+}
+
 #define ERROR_HANDLER(x,msg) extern "C" void arch_errorHandler_##x(); \
   extern "C" void errorHandler_##x () \
   {\
@@ -152,7 +185,7 @@ extern "C" void irqHandler_0()
 extern "C" void arch_irqHandler_65();
 extern "C" void irqHandler_65()
 {
-  Scheduler::instance()->schedule();
+  Scheduler::instance()->schedule(true);
   // kprintfd("irq65: Going to leave int Handler 65 to user\n");
   arch_contextSwitch();
 }
@@ -377,5 +410,42 @@ extern "C" void syscallHandler()
   arch_contextSwitch();
 }
 
+/**
+ * called by arch_fastSyscallHandler, returns to userspace with SYSEXIT instead of arch_contextSwitch
+ */
+extern "C" size_t fastSyscallHandler(size_t arg1, size_t arg2, size_t arg3, size_t arg4, size_t arg5, size_t arg6,
+                                     size_t* user_return)
+{
+  currentThread->switch_to_userspace_ = false;
+  currentThreadInfo = currentThread->kernel_arch_thread_info_;
+  ArchInterrupts::enableInterrupts();
+
+  // user_return[1] is the esp of the stub, the return address on top of its stack is read like any user memory
+  size_t user_esp = user_return[1];
+  if (user_esp >= 2U*1024U*1024U*1024U - sizeof(size_t))
+  {
+    debug(A_INTERRUPTS, "fastSyscallHandler: invalid user stack %x\n", user_esp);
+    currentThread->kill();
+  }
+  user_return[0] = *(size_t*) user_esp;
+
+  size_t return_value = Syscall::syscallException(arg1, arg2, arg3, arg4, arg5, arg6);
+
+  ArchInterrupts::disableInterrupts();
+  currentThread->switch_to_userspace_ = true;
+  currentThreadInfo = currentThread->user_arch_thread_info_;
+  currentThreadInfo->eax = return_value;
+  // what arch_contextSwitch would do besides restoring the registers
+  g_tss->esp0 = currentThreadInfo->esp0;
+  ArchFpu::switchTo(currentThreadInfo);
+  return return_value;
+}
+
+extern "C" void arch_errorHandler_7();
+extern "C" void errorHandler_7()
+{
+  ArchFpu::handleDeviceNotAvailable();
+}
+
 #include "ErrorHandlers.h" // error handler definitions and irq forwarding definitions
 
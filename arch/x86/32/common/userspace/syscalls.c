@@ -1,8 +1,35 @@
 #include "types.h"
 
+#define CPUID_FEATURE_SEP (1 << 11)
+
+static int sysenter_available = -1;
+
+static int checkSysenter()
+{
+  size_t eax = 1, ebx, ecx, edx;
+  asm volatile("cpuid" : "+a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx));
+  return (edx & CPUID_FEATURE_SEP) != 0;
+}
+
 size_t __syscall(size_t arg1, size_t arg2, size_t arg3, size_t arg4, size_t arg5,
                         size_t arg6)
                         {
-  asm("int $0x80\n" : "=a"(arg1) : "a"(arg1), "b"(arg2), "c"(arg3), "d"(arg4), "S"(arg5), "D"(arg6));
+  if (sysenter_available < 0)
+    sysenter_available = checkSysenter();
+  if (!sysenter_available)
+  {
+    asm("int $0x80\n" : "=a"(arg1) : "a"(arg1), "b"(arg2), "c"(arg3), "d"(arg4), "S"(arg5), "D"(arg6));
+    return arg1;
+  }
+  // the kernel gets our stack pointer in ebp and returns with SYSEXIT to the address on top of that stack
+  asm volatile("pushl %%ebp\n"
+               "pushl $1f\n"
+               "movl %%esp, %%ebp\n"
+               "sysenter\n"
+               "1: addl $4, %%esp\n"
+               "popl %%ebp\n"
+               : "+a"(arg1), "+c"(arg3), "+d"(arg4)
+               : "b"(arg2), "S"(arg5), "D"(arg6)
+               : "memory");
   return arg1;
 }
@@ -101,6 +101,15 @@ public:
  * returns the page size in byte (4096 for 4KiB pages or 4096*1024 for 4MiB pages)
  */
   static uint32 get_PPN_Of_VPN_In_KernelMapping(uint32 virtual_page, size_t *physical_page, uint32 *physical_pte_page=0);
+/**
+ * Like get_PPN_Of_VPN_In_KernelMapping, but looks the virtual page up in this address space
+ * (including its user pages)
+ * @param virtual_page virtual Page to look up
+ * @param *physical_page Pointer to the result
+ * @return 0: if the virtual page doesn't map to any physical page\notherwise
+ * returns the page size in byte
+ */
+  uint32 get_PPN_Of_VPN(uint32 virtual_page, size_t *physical_page);
   static uint32 get_PAddr_Of_VAddr_In_KernelMapping(uint32 virtual_addr);
 
 /**
@@ -129,6 +138,19 @@ public:
   static const size_t RESERVED_START = 0x80000ULL;
   static const size_t RESERVED_END = 0xC0000ULL;
 
+/**
+ * user space is mapped in 4KiB pages only here, see the x86_64 ArchMemory for huge pages
+ */
+  static const size_t HUGE_PAGE_SIZE = 0;
+  bool mapHugePage(uint32, uint32)
+  {
+    return false;
+  }
+  static size_t getHugePageMemory()
+  {
+    return 0;
+  }
+
 private:
 
   void insertPD(uint32 pdpt_vpn, uint32 physical_page_directory_page);
@@ -158,6 +158,23 @@ void ArchMemory::freePageDirectory(uint32 physical_page_directory_page)
   PageManager::instance()->freePPN(physical_page_directory_page);
 }
 
+uint32 ArchMemory::get_PPN_Of_VPN(uint32 virtual_page, size_t *physical_page)
+{
+  RESOLVEMAPPING(page_dir_pointer_table_, virtual_page);
+  if (!page_dir_pointer_table_[pdpte_vpn].present || !page_directory[pde_vpn].pt.present)
+    return 0;
+  if (page_directory[pde_vpn].page.size)
+  {
+    *physical_page = page_directory[pde_vpn].page.page_ppn;
+    return PAGE_SIZE * PAGE_TABLE_ENTRIES;
+  }
+  PageTableEntry *pte_base = (PageTableEntry *) getIdentAddressOfPPN(page_directory[pde_vpn].pt.page_table_ppn);
+  if (!pte_base[pte_vpn].present)
+    return 0;
+  *physical_page = pte_base[pte_vpn].page_ppn;
+  return PAGE_SIZE;
+}
+
 bool ArchMemory::checkAddressValid(uint32 vaddress_to_check)
 {
   RESOLVEMAPPING(page_dir_pointer_table_, vaddress_to_check / PAGE_SIZE);
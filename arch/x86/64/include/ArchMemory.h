@@ -10,6 +10,7 @@
 #include "types.h"
 #include "offsets.h"
 #include "paging-definitions.h"
+#include "Atomic.h"
 
 class ArchMemoryMapping
 {
@@ -63,8 +64,19 @@ public:
  */
   bool mapPage(uint64 virtual_page, uint64 physical_page, uint64 user_access, uint64 page_size=PAGE_SIZE);
 
+/**
+ * maps a zeroed 2MiB page for user space, if none of its 4KiB pages is mapped yet and the PageManager has
+ * a free 2MiB block to spare. The caller falls back to 4KiB pages otherwise.
+ *
+ * @param virtual_page the first page of the 2MiB region, aligned to HUGE_PAGE_SIZE
+ * @param user_access PTE User/Supervisor Flag
+ * @return true if the huge page was mapped
+ */
+  bool mapHugePage(uint64 virtual_page, uint64 user_access);
+
 /**
  * removes the mapping to a virtual_page by marking its PTE Entry as non valid
+ * a 2MiB page containing virtual_page is split into 4KiB pages first
  *
  * @param physical_page_directory_page Real Page where the PDE to work on resides
  * @param virtual_page which will be invalidated
@@ -115,6 +127,15 @@ public:
  * returns the page size in byte (4096 for 4KiB pages or 4096*1024 for 4MiB pages)
  */
   static uint64 get_PPN_Of_VPN_In_KernelMapping(uint64 virtual_page, uint64 *physical_page, uint64 *physical_pte_page=0);
+/**
+ * Like get_PPN_Of_VPN_In_KernelMapping, but looks the virtual page up in this address space
+ * (including its user pages)
+ * @param virtual_page virtual Page to look up
+ * @param *physical_page Pointer to the result
+ * @return 0: if the virtual page doesn't map to any physical page\notherwise
+ * returns the page size in byte
+ */
+  uint64 get_PPN_Of_VPN(uint64 virtual_page, uint64 *physical_page);
   static uint64 get_PAddr_Of_VAddr_In_KernelMapping(uint64 virtual_addr);
   static ArchMemoryMapping resolveMapping(uint64 pml4,uint64 vpage);
 
@@ -143,6 +164,13 @@ public:
   static const size_t RESERVED_START = 0xFFFFFFFF80000ULL;
   static const size_t RESERVED_END = 0xFFFFFFFFC0000ULL;
 
+  static const size_t HUGE_PAGE_SIZE = PAGE_SIZE * PAGE_TABLE_ENTRIES;
+
+/**
+ * @return the user memory of all address spaces which is mapped in 2MiB pages, in bytes
+ */
+  static size_t getHugePageMemory();
+
 private:
 
 /** 
@@ -166,6 +194,13 @@ private:
  */
   template<typename T> static bool checkAndRemove(pointer map_ptr, uint64 index);
 
+/**
+ * replaces the 2MiB page of the mapping by a page table mapping the same memory in 4KiB pages
+ */
+  static void splitHugePage(ArchMemoryMapping& m);
+
+  static Atomic<size_t> huge_pages_;
+
 };
 
 #endif
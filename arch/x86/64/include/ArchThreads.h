@@ -40,7 +40,7 @@ struct ArchThreadInfo
   uint64  rsp0;      // 200
   uint64  ss0;       // 208
   uint64  cr3;       // 216
-  uint32  fpu[28];   // 224
+  uint8*  fpu_state; // 224, see ArchFpu
 };
 
 class Thread;
@@ -67,6 +67,14 @@ public:
  */
   static void initialise();
 
+/**
+ * deletes the info if not null
+ *
+ * @param info to be cleaned up
+ *
+ */
+  static void cleanupThreadInfos(ArchThreadInfo *&info);
+
 /**
  * creates the ArchThreadInfo for a kernel thread
  * @param info where the ArchThreadInfo is saved
@@ -102,6 +110,12 @@ public:
  */
   static void yield();
 
+/**
+ * tells the CPU that it is executing a busy waiting loop (pause on x86),
+ * to be called in each iteration of the loop
+ */
+  static void spinLoopHint();
+
 /**
  * sets a threads page map level 4
  *
@@ -128,6 +142,16 @@ public:
  */
   static size_t testSetLock(size_t &lock, size_t new_value);
 
+/**
+ * atomically replaces target with new_value if it still contains expected
+ *
+ * @param &target Reference to the variable being replaced
+ * @param expected the value target has to contain
+ * @param new_value to set target to
+ * @returns old value of target, the replacement happened iff it equals expected
+ */
+  static size_t atomic_cmpxchg(size_t &target, size_t expected, size_t new_value);
+
 /**
  * atomically increments or decrements value by increment
  *
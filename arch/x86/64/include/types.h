@@ -31,15 +31,18 @@ typedef int64 ssize_t;
 #define Min(x,y) (((x)<(y))?(x):(y))
 #define Max(x,y) (((x)>(y))?(x):(y))
 
+// SYSCALL takes the kernel SS from KERNEL_CS + 8, SYSRET the user SS and CS from SYSRET_SELECTOR_BASE + 8 and + 16.
+// KERNEL_SS and USER_CS are 8 byte descriptors in the (otherwise unused) upper halves of the KERNEL_CS and USER_DS entries
 #define KERNEL_CS 0x10
 #define KERNEL_DS 0x20
-#define KERNEL_SS 0x20
+#define KERNEL_SS 0x18
 #define KERNEL_TSS 0x50
 #define DPL_KERNEL  0
 #define DPL_USER    3
-#define USER_CS (0x30|DPL_USER)
+#define USER_CS (0x48|DPL_USER)
 #define USER_DS ((0x40)|DPL_USER)
 #define USER_SS ((0x40)|DPL_USER)
+#define SYSRET_SELECTOR_BASE 0x38
 
 #define likely(x)       __builtin_expect((x),1)
 #define unlikely(x)     __builtin_expect((x),0)
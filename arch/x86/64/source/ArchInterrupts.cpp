@@ -8,6 +8,7 @@
 #include "ports.h"
 #include "InterruptUtils.h"
 #include "ArchThreads.h"
+#include "ArchFpu.h"
 #include "assert.h"
 #include "Thread.h"
 
@@ -31,6 +32,12 @@ void ArchInterrupts::disableTimer()
   disableIRQ(0);
 }
 
+uint32 ArchInterrupts::getTimerFrequency()
+{
+  // the PIT is left at the BIOS default: 1193182 Hz / 65536
+  return 18206;
+}
+
 void ArchInterrupts::enableKBD()
 {
   enableIRQ(1);
@@ -123,11 +130,6 @@ extern "C" void arch_saveThreadRegisters(uint64* base, uint64 error)
   register struct interrupt_registers* iregisters;
   iregisters = (struct interrupt_registers*) (base + sizeof(struct context_switch_registers)/sizeof(uint64) + error);
   register ArchThreadInfo* info = currentThreadInfo;
-  asm("fnsave %[fpu]\n"
-      "frstor %[fpu]\n"
-      :
-      : [fpu]"m"((info->fpu))
-      :);
   info->rsp = iregisters->rsp;
   info->rip = iregisters->rip;
   info->cs = iregisters->cs;
@@ -164,7 +166,7 @@ extern "C" void arch_contextSwitch()
   assert(currentThread->stack_[0] == STACK_CANARY);
   ArchThreadInfo info = *currentThreadInfo; // optimization: local copy produces more efficient code in this case
   g_tss.rsp0 = info.rsp0;
-  asm("frstor %[fpu]\n" : : [fpu]"m"(info.fpu));
+  ArchFpu::switchTo(currentThreadInfo);
   asm("mov %[cr3], %%cr3\n" : : [cr3]"r"(info.cr3));
   asm("push %[ss]" : : [ss]"m"(info.ss));
   asm("push %[rsp]" : : [rsp]"m"(info.rsp));
@@ -16,6 +16,11 @@ PageDirEntry kernel_page_directory[2 * PAGE_DIR_ENTRIES] __attribute__((aligned(
 PageTableEntry kernel_page_table[8 * PAGE_TABLE_ENTRIES] __attribute__((aligned(0x1000)));
 ;
 
+// a huge page is only used while at least this many 4KiB pages stay free besides it
+#define HUGE_PAGE_MIN_FREE_PAGES (2 * PAGE_TABLE_ENTRIES)
+
+Atomic<size_t> ArchMemory::huge_pages_(0);
+
 ArchMemory::ArchMemory()
 {
   page_map_level_4_ = PageManager::instance()->allocPPN();
@@ -42,6 +47,11 @@ bool ArchMemory::unmapPage(uint64 virtual_page)
 {
   ArchMemoryMapping m = resolveMapping(page_map_level_4_, virtual_page);
 
+  if (m.page_size == HUGE_PAGE_SIZE)
+  {
+    splitHugePage(m);
+    m = resolveMapping(page_map_level_4_, virtual_page);
+  }
   assert(m.page_ppn != 0 && m.page_size == PAGE_SIZE);
   bool empty = checkAndRemove<PageTableEntry>(getIdentAddressOfPPN(m.pt_ppn), m.pti);
   if (empty)
@@ -120,6 +130,51 @@ bool ArchMemory::mapPage(uint64 virtual_page, uint64 physical_page, uint64 user_
   return false;
 }
 
+bool ArchMemory::mapHugePage(uint64 virtual_page, uint64 user_access)
+{
+  assert(virtual_page % PAGE_TABLE_ENTRIES == 0);
+  ArchMemoryMapping m = resolveMapping(page_map_level_4_, virtual_page);
+  // part of the region is mapped in 4KiB pages already
+  if (m.pt_ppn != 0 || m.page != 0)
+    return false;
+  if (PageManager::instance()->getNumFreePages() < PAGE_TABLE_ENTRIES + HUGE_PAGE_MIN_FREE_PAGES)
+    return false;
+  uint64 ppn = PageManager::instance()->tryAllocPPN(HUGE_PAGE_SIZE);
+  if (ppn == 0)
+    return false;
+
+  memset((void*) getIdentAddressOfPPN(ppn), 0, HUGE_PAGE_SIZE);
+  mapPage(virtual_page, ppn / PAGE_TABLE_ENTRIES, user_access, HUGE_PAGE_SIZE);
+  huge_pages_.fetchAdd(1, MEMORY_ORDER_RELAXED);
+  debug(A_MEMORY, "mapHugePage: %x -> %x\n", virtual_page, ppn);
+  return true;
+}
+
+void ArchMemory::splitHugePage(ArchMemoryMapping& m)
+{
+  PageDirPageEntry huge_page = m.pd[m.pdi].page;
+  uint64 pt_ppn = PageManager::instance()->allocPPN();
+  PageTableEntry* pt = (PageTableEntry*) getIdentAddressOfPPN(pt_ppn);
+  memset((void*) pt, 0, PAGE_SIZE);
+  for (uint64 pti = 0; pti < PAGE_TABLE_ENTRIES; pti++)
+  {
+    pt[pti].writeable = huge_page.writeable;
+    pt[pti].user_access = huge_page.user_access;
+    pt[pti].page_ppn = huge_page.page_ppn * PAGE_TABLE_ENTRIES + pti;
+    pt[pti].present = 1;
+  }
+  // the PageManager hands out the 4KiB pages of a 2MiB block one by one again
+  ((uint64*) m.pd)[m.pdi] = 0;
+  insert<PageDirPageTableEntry>((pointer) m.pd, m.pdi, pt_ppn, 0, 0, 1, 1);
+  huge_pages_.fetchSub(1, MEMORY_ORDER_RELAXED);
+  debug(A_MEMORY, "splitHugePage: %x split into page table %x\n", huge_page.page_ppn, pt_ppn);
+}
+
+size_t ArchMemory::getHugePageMemory()
+{
+  return huge_pages_.load(MEMORY_ORDER_RELAXED) * HUGE_PAGE_SIZE;
+}
+
 ArchMemory::~ArchMemory()
 {
   PageMapLevel4Entry* pml4 = (PageMapLevel4Entry*) getIdentAddressOfPPN(page_map_level_4_);
@@ -149,6 +204,12 @@ ArchMemory::~ArchMemory()
               pd[pdi].pt.present = 0;
               PageManager::instance()->freePPN(pd[pdi].pt.page_ppn);
             }
+            else if (pd[pdi].page.present)
+            {
+              pd[pdi].page.present = 0;
+              PageManager::instance()->freePPN(pd[pdi].page.page_ppn * PAGE_TABLE_ENTRIES, HUGE_PAGE_SIZE);
+              huge_pages_.fetchSub(1, MEMORY_ORDER_RELAXED);
+            }
           }
           pdpt[pdpti].pd.present = 0;
           PageManager::instance()->freePPN(pdpt[pdpti].pd.page_ppn);
@@ -187,6 +248,15 @@ bool ArchMemory::checkAddressValid(uint64 vaddress_to_check)
   }
 }
 
+uint64 ArchMemory::get_PPN_Of_VPN(uint64 virtual_page, uint64 *physical_page)
+{
+  ArchMemoryMapping m = resolveMapping(page_map_level_4_, virtual_page);
+  if (!m.page)
+    return 0;
+  *physical_page = m.page_ppn;
+  return m.page_size;
+}
+
 uint64 ArchMemory::get_PAddr_Of_VAddr_In_KernelMapping(uint64 virtual_addr)
 {
   uint64 physical_addr;
@@ -1,5 +1,7 @@
 #include "ArchThreads.h"
+#include "SlabAllocator.h"
 #include "ArchMemory.h"
+#include "ArchFpu.h"
 #include "kprintf.h"
 #include "paging-definitions.h"
 #include "offsets.h"
@@ -9,11 +11,30 @@
 
 extern PageMapLevel4Entry kernel_page_map_level_4[];
 
+static SlabCache* thread_info_cache;
+
+static ArchThreadInfo* allocateThreadInfo()
+{
+  return (ArchThreadInfo*) SlabAllocator::instance()->getCache(thread_info_cache, "ArchThreadInfo",
+                                                               sizeof(ArchThreadInfo))->allocate(sizeof(ArchThreadInfo));
+}
+
 void ArchThreads::initialise()
 {
-  currentThreadInfo = (ArchThreadInfo*) new uint8[sizeof(ArchThreadInfo)];
+  currentThreadInfo = allocateThreadInfo();
+  memset((void*)currentThreadInfo, 0, sizeof(ArchThreadInfo));
+  ArchFpu::initialise();
+}
 
+void ArchThreads::cleanupThreadInfos(ArchThreadInfo *&info)
+{
+  if (!info)
+    return;
+  ArchFpu::destroyState(info);
+  thread_info_cache->free(info, sizeof(ArchThreadInfo));
+  info = 0;
 }
+
 void ArchThreads::setAddressSpace(Thread *thread, ArchMemory& arch_memory)
 {
   assert(arch_memory.page_map_level_4_);
@@ -30,7 +51,7 @@ uint32 ArchThreads::getPageDirPointerTable(Thread *thread)
 
 void ArchThreads::createThreadInfosKernelThread(ArchThreadInfo *&info, pointer start_function, pointer stack)
 {
-  info = (ArchThreadInfo*)new uint8[sizeof(ArchThreadInfo)];
+  info = allocateThreadInfo();
   memset((void*)info, 0, sizeof(ArchThreadInfo));
   pointer pml4 = (pointer)VIRTUAL_TO_PHYSICAL_BOOT(kernel_page_map_level_4);
 
@@ -46,14 +67,7 @@ void ArchThreads::createThreadInfosKernelThread(ArchThreadInfo *&info, pointer s
   info->cr3     = pml4;
   assert(info->cr3);
 
- /* fpu (=fninit) */
-  info->fpu[0] = 0xFFFF037F;
-  info->fpu[1] = 0xFFFF0000;
-  info->fpu[2] = 0xFFFFFFFF;
-  info->fpu[3] = 0x00000000;
-  info->fpu[4] = 0x00000000;
-  info->fpu[5] = 0x00000000;
-  info->fpu[6] = 0xFFFF0000;
+  ArchFpu::createState(info);
 }
 
 void ArchThreads::changeInstructionPointer(ArchThreadInfo *info, pointer function)
@@ -63,7 +77,7 @@ void ArchThreads::changeInstructionPointer(ArchThreadInfo *info, pointer functio
 
 void ArchThreads::createThreadInfosUserspaceThread(ArchThreadInfo *&info, pointer start_function, pointer user_stack, pointer kernel_stack)
 {
-  info = (ArchThreadInfo*)new uint8[sizeof(ArchThreadInfo)];
+  info = allocateThreadInfo();
   memset((void*)info, 0, sizeof(ArchThreadInfo));
   pointer pml4 = (pointer)VIRTUAL_TO_PHYSICAL_BOOT(kernel_page_map_level_4);
 
@@ -81,14 +95,7 @@ void ArchThreads::createThreadInfosUserspaceThread(ArchThreadInfo *&info, pointe
   info->cr3     = pml4;
   assert(info->cr3);
 
- /* fpu (=fninit) */
-  info->fpu[0] = 0xFFFF037F;
-  info->fpu[1] = 0xFFFF0000;
-  info->fpu[2] = 0xFFFFFFFF;
-  info->fpu[3] = 0x00000000;
-  info->fpu[4] = 0x00000000;
-  info->fpu[5] = 0x00000000;
-  info->fpu[6] = 0xFFFF0000;
+  ArchFpu::createState(info);
   //kprintfd("ArchThreads::create: values done\n");
 
 }
@@ -101,20 +108,24 @@ void ArchThreads::yield()
   );
 }
 
+void ArchThreads::spinLoopHint()
+{
+  __asm__ __volatile__("pause");
+}
+
 size_t ArchThreads::testSetLock(size_t &lock, size_t new_value)
 {
   return __sync_lock_test_and_set(&lock,new_value);
 }
 
+size_t ArchThreads::atomic_cmpxchg(size_t &target, size_t expected, size_t new_value)
+{
+  return __sync_val_compare_and_swap(&target, expected, new_value);
+}
+
 uint64 ArchThreads::atomic_add(uint64 &value, int64 increment)
 {
-  int32 ret=increment;
-  __asm__ __volatile__(
-  "lock; xadd %0, %1;"
-  :"=a" (ret), "=m" (value)
-  :"a" (ret)
-  :);
-  return ret;
+  return __sync_fetch_and_add(&value,increment);
 }
 
 int64 ArchThreads::atomic_add(int64 &value, int64 increment)
@@ -6,6 +6,7 @@
 #include "ports.h"
 #include "ArchMemory.h"
 #include "ArchThreads.h"
+#include "ArchFpu.h"
 #include "ArchCommon.h"
 #include "Console.h"
 #include "Terminal.h"
@@ -42,6 +43,16 @@
 
 #define SYSCALL_INTERRUPT 0x80 // number of syscall interrupt
 
+#define MSR_EFER  0xC0000080
+#define MSR_STAR  0xC0000081
+#define MSR_LSTAR 0xC0000082
+#define MSR_FMASK 0xC0000084
+#define EFER_SCE (1 << 0)   // SYSCALL/SYSRET enable
+
+#define RFLAGS_TF (1 << 8)
+#define RFLAGS_IF (1 << 9)
+#define RFLAGS_DF (1 << 10)
+
 
 // --- Pagefault error flags.
 //     PF because/in/caused by/...
@@ -119,6 +130,7 @@ void InterruptUtils::initialise()
   idtr.base = (pointer) interrupt_gates;
   idtr.limit = sizeof(GateDesc) * num_handlers - 1;
   lidt(&idtr);
+  initialiseFastSyscalls();
   pf_address = 0xdeadbeef;
   pf_address_counter = 0;
 }
@@ -128,6 +140,30 @@ void InterruptUtils::lidt(IDTR *idtr)
   asm volatile("lidt (%0) ": :"q" (idtr));
 }
 
+static uint64 rdmsr(uint32 msr)
+{
+  uint32 low, high;
+  asm volatile("rdmsr" : "=a"(low), "=d"(high) : "c"(msr));
+  return ((uint64) high << 32) | low;
+}
+
+static void wrmsr(uint32 msr, uint64 value)
+{
+  asm volatile("wrmsr" : : "c"(msr), "a"((uint32) value), "d"((uint32) (value >> 32)));
+}
+
+extern "C" void arch_fastSyscallHandler();
+
+void InterruptUtils::initialiseFastSyscalls()
+{
+  // SYSCALL/SYSRET are always available in long mode
+  wrmsr(MSR_STAR, ((uint64) SYSRET_SELECTOR_BASE << 48) | ((uint64) KERNEL_CS << 32));
+  wrmsr(MSR_LSTAR, (uint64) arch_fastSyscallHandler);
+  // the handler starts with interrupts disabled, like behind an interrupt gate
+  wrmsr(MSR_FMASK, RFLAGS_TF | RFLAGS_IF | RFLAGS_DF);
+  wrmsr(MSR_EFER, rdmsr(MSR_EFER) | EFER_SCE);
+}
+
 void InterruptUtils::countPageFault(uint64 address)
 {
   if (address == pf_address)
@@ -196,7 +232,7 @@ extern "C" void irqHandler_0()
 extern "C" void arch_irqHandler_65();
 extern "C" void irqHandler_65()
 {
-  Scheduler::instance()->schedule();
+  Scheduler::instance()->schedule(true);
   arch_contextSwitch();
 }
 
@@ -394,5 +430,39 @@ extern "C" void syscallHandler()
   arch_contextSwitch();
 }
 
+typedef struct {
+    uint32 padding;
+    uint64 rsp0; // actually the TSS has more fields, but we don't need them
+} __attribute__((__packed__))TSS;
+
+extern TSS g_tss;
+
+/**
+ * called by arch_fastSyscallHandler, returns to userspace with SYSRET instead of arch_contextSwitch
+ */
+extern "C" size_t fastSyscallHandler(size_t arg1, size_t arg2, size_t arg3, size_t arg4, size_t arg5, size_t arg6)
+{
+  currentThread->switch_to_userspace_ = false;
+  currentThreadInfo = currentThread->kernel_arch_thread_info_;
+  ArchInterrupts::enableInterrupts();
+
+  size_t return_value = Syscall::syscallException(arg1, arg2, arg3, arg4, arg5, arg6);
+
+  ArchInterrupts::disableInterrupts();
+  currentThread->switch_to_userspace_ = true;
+  currentThreadInfo = currentThread->user_arch_thread_info_;
+  currentThreadInfo->rax = return_value;
+  // what arch_contextSwitch would do besides restoring the registers
+  g_tss.rsp0 = currentThreadInfo->rsp0;
+  ArchFpu::switchTo(currentThreadInfo);
+  return return_value;
+}
+
+extern "C" void arch_errorHandler_7();
+extern "C" void errorHandler_7()
+{
+  ArchFpu::handleDeviceNotAvailable();
+}
+
 #include "ErrorHandlers.h" // error handler definitions and irq forwarding definitions
 
@@ -1,4 +1,16 @@
-void __syscall()
+#include "types.h"
+
+size_t __syscall(size_t arg1, size_t arg2, size_t arg3, size_t arg4, size_t arg5,
+                        size_t arg6)
 {
-  asm("int $0x80");
+  // same registers as for a function call, except that SYSCALL takes rcx for the return address
+  register size_t r10 asm("r10") = arg4;
+  register size_t r8 asm("r8") = arg5;
+  register size_t r9 asm("r9") = arg6;
+  size_t result;
+  asm volatile("syscall\n"
+               : "=a"(result), "+D"(arg1), "+S"(arg2), "+d"(arg3), "+r"(r10), "+r"(r8), "+r"(r9)
+               :
+               : "rcx", "r11", "memory");
+  return result;
 }
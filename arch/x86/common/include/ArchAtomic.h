@@ -0,0 +1,102 @@
+#ifndef _ARCH_ATOMIC_H_
+#define _ARCH_ATOMIC_H_
+
+/**
+ * @class ArchAtomic
+ * The atomic operations behind Atomic (include Atomic.h instead of this file).
+ * On x86 every locked instruction is a full barrier anyway, but loads are plain moves for all
+ * orders and stores only need the locked xchg for MEMORY_ORDER_SEQ_CST.
+ * The kernel is compiled without optimization, the order is therefore turned into the constant
+ * the builtins need by a switch, otherwise they would fall back to the full barrier.
+ */
+class ArchAtomic
+{
+  public:
+    template<typename T>
+    static T load(const T& value, MemoryOrder order)
+    {
+      switch (order)
+      {
+        case MEMORY_ORDER_RELAXED:
+          return __atomic_load_n(&value, __ATOMIC_RELAXED);
+        case MEMORY_ORDER_ACQUIRE:
+        case MEMORY_ORDER_ACQ_REL:
+          return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+        default:
+          return __atomic_load_n(&value, __ATOMIC_SEQ_CST);
+      }
+    }
+
+    template<typename T>
+    static void store(T& target, T value, MemoryOrder order)
+    {
+      switch (order)
+      {
+        case MEMORY_ORDER_RELAXED:
+          __atomic_store_n(&target, value, __ATOMIC_RELAXED);
+          break;
+        case MEMORY_ORDER_RELEASE:
+        case MEMORY_ORDER_ACQ_REL:
+          __atomic_store_n(&target, value, __ATOMIC_RELEASE);
+          break;
+        default:
+          __atomic_store_n(&target, value, __ATOMIC_SEQ_CST);
+      }
+    }
+
+    template<typename T>
+    static T exchange(T& target, T value, MemoryOrder order)
+    {
+      switch (order)
+      {
+        case MEMORY_ORDER_RELAXED:
+          return __atomic_exchange_n(&target, value, __ATOMIC_RELAXED);
+        case MEMORY_ORDER_ACQUIRE:
+          return __atomic_exchange_n(&target, value, __ATOMIC_ACQUIRE);
+        case MEMORY_ORDER_RELEASE:
+          return __atomic_exchange_n(&target, value, __ATOMIC_RELEASE);
+        case MEMORY_ORDER_ACQ_REL:
+          return __atomic_exchange_n(&target, value, __ATOMIC_ACQ_REL);
+        default:
+          return __atomic_exchange_n(&target, value, __ATOMIC_SEQ_CST);
+      }
+    }
+
+    template<typename T>
+    static bool compareExchange(T& target, T& expected, T desired, MemoryOrder order)
+    {
+      switch (order)
+      {
+        case MEMORY_ORDER_RELAXED:
+          return __atomic_compare_exchange_n(&target, &expected, desired, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        case MEMORY_ORDER_ACQUIRE:
+          return __atomic_compare_exchange_n(&target, &expected, desired, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE);
+        case MEMORY_ORDER_RELEASE:
+          return __atomic_compare_exchange_n(&target, &expected, desired, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+        case MEMORY_ORDER_ACQ_REL:
+          return __atomic_compare_exchange_n(&target, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+        default:
+          return __atomic_compare_exchange_n(&target, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+      }
+    }
+
+    template<typename T>
+    static T fetchAdd(T& target, T increment, MemoryOrder order)
+    {
+      switch (order)
+      {
+        case MEMORY_ORDER_RELAXED:
+          return __atomic_fetch_add(&target, increment, __ATOMIC_RELAXED);
+        case MEMORY_ORDER_ACQUIRE:
+          return __atomic_fetch_add(&target, increment, __ATOMIC_ACQUIRE);
+        case MEMORY_ORDER_RELEASE:
+          return __atomic_fetch_add(&target, increment, __ATOMIC_RELEASE);
+        case MEMORY_ORDER_ACQ_REL:
+          return __atomic_fetch_add(&target, increment, __ATOMIC_ACQ_REL);
+        default:
+          return __atomic_fetch_add(&target, increment, __ATOMIC_SEQ_CST);
+      }
+    }
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef _ARCH_FPU_H_
+#define _ARCH_FPU_H_
+
+#include "types.h"
+
+struct ArchThreadInfo;
+
+/**
+ * size of the register save area of a thread:
+ * the legacy fxsave area (512 bytes), the xsave header (64 bytes) and the upper halves of the AVX registers (256 bytes)
+ */
+#define FPU_STATE_SIZE 832
+
+/**
+ * xsave needs a 64 byte aligned save area (fxsave 16 byte)
+ */
+#define FPU_STATE_ALIGNMENT 64
+
+/**
+ * @class ArchFpu
+ * Lazy switching of the x87 FPU, SSE and AVX registers.
+ *
+ * The registers are not saved and restored on every context switch. Instead CR0.TS is set whenever
+ * a thread info other than the owner of the registers is resumed, so its first FPU/SSE instruction
+ * raises #NM (device not available). The handler saves the registers into the save area of the
+ * previous owner, loads the ones of the currentThreadInfo and makes it the new owner.
+ * Threads which never use the FPU (i.e. most kernel threads) never pay for it.
+ *
+ * The owner is an ArchThreadInfo, not a Thread: the kernel and user context of a thread have
+ * separate register sets, as before. Interrupt handlers change the currentThreadInfo without
+ * going through switchTo(), therefore kernel code must not use the FPU outside of kernel threads.
+ *
+ * Depending on the CPU the registers are saved with xsave (x87, SSE and AVX), fxsave (x87 and SSE)
+ * or fnsave (x87 only).
+ */
+class ArchFpu
+{
+  public:
+    /**
+     * enables the FPU and, if available, SSE (CR4.OSFXSR) and xsave/AVX (CR4.OSXSAVE, XCR0)
+     * has to be called before the first thread is started
+     */
+    static void initialise();
+
+    /**
+     * allocates the register save area of a new thread info and sets it to the state after fninit
+     * @param info the new thread info
+     */
+    static void createState(ArchThreadInfo* info);
+
+    /**
+     * frees the register save area, if the thread info owns the registers they are dropped
+     * @param info the thread info which is about to be deleted
+     */
+    static void destroyState(ArchThreadInfo* info);
+
+    /**
+     * called right before a thread info is resumed,
+     * sets CR0.TS unless the thread info already owns the registers
+     * @param info the thread info which will be resumed
+     */
+    static void switchTo(ArchThreadInfo* info);
+
+    /**
+     * #NM handler, hands the registers over to the currentThreadInfo
+     */
+    static void handleDeviceNotAvailable();
+
+  private:
+    enum SaveMode
+    {
+      FNSAVE, FXSAVE, XSAVE
+    };
+
+    static void detectSaveMode();
+    static uint8* alignedState(ArchThreadInfo* info);
+    static void save(uint8* state);
+    static void restore(uint8* state);
+
+    static SaveMode save_mode_;
+    static bool save_mode_detected_;
+
+    /**
+     * the thread info whose registers are currently loaded, 0 if none
+     */
+    static ArchThreadInfo* owner_;
+};
+
+#endif
@@ -12,7 +12,6 @@ ERROR_HANDLER(0,#DE: Divide by Zero)
 ERROR_HANDLER(4,#OF: Overflow (INTO Instruction))
 ERROR_HANDLER(5,#BR: Bound Range Exceeded)
 ERROR_HANDLER(6,#OP: Invalid OP Code)
-ERROR_HANDLER(7,#NM: FPU Not Avaiable or Ready)
 ERROR_HANDLER(8,#DF: Double Fault)
 ERROR_HANDLER(9,#MF: FPU Segment Overrun)
 ERROR_HANDLER(10,#TS: Invalid Task State Segment (TSS))
@@ -45,6 +45,12 @@ public:
    */
   static void lidt(IDTR *idtr);
 
+  /**
+   * sets up the MSRs for the fast system call entry
+   * (SYSCALL/SYSRET on x86_64, SYSENTER/SYSEXIT on x86/32 if the CPU supports it)
+   */
+  static void initialiseFastSyscalls();
+
   /**
    *
    */
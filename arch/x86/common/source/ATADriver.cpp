@@ -5,7 +5,6 @@
 #include "ArchInterrupts.h"
 #include "8259.h"
 
-#include "Scheduler.h"
 #include "kprintf.h"
 
 #include "Thread.h"
@@ -260,18 +259,28 @@ uint32 ATADriver::addRequest( BDRequest *br )
     return 0;
   }
 
-  if (currentThread)
+  // the controller processes one request at a time, therefore lock_ is kept until
+  // serviceIRQ is done with it. The interrupts are still disabled, so the wake up
+  // cannot happen between checking the status and going to sleep.
+  size_t timeout_ticks = ArchInterrupts::getTimerFrequency() * BD_REQUEST_TIMEOUT_SECONDS / 1000 + 1;
+  jiffies = 0;
+  while( br->getStatus() == BDRequest::BD_QUEUED && jiffies++ < IO_TIMEOUT )
   {
-    if(interrupt_context)
-    {
-      currentThread->state_=Sleeping;
-      ArchInterrupts::enableInterrupts();
-      Scheduler::instance()->yield();
-    }
-    else
-      currentThread->state_=Sleeping;
+    if( !br->getWaitQueue().waitWithTimeout( timeout_ticks ) )
+      break;
   }
 
+  if( br->getStatus() == BDRequest::BD_QUEUED )
+  {
+    debug(ATA_DRIVER, "addRequest: no interrupt for the request, giving up!!\n");
+    // a late interrupt must not write into the buffer of the request any more
+    request_list_ = br->getNextRequest();
+    br->setStatus( BDRequest::BD_ERROR );
+  }
+
+  if( interrupt_context )
+    ArchInterrupts::enableInterrupts();
+
   return 0;
 }
 
@@ -321,8 +330,6 @@ void ATADriver::serviceIRQ()
     if( !waitForController() )
     {
       br->setStatus( BDRequest::BD_ERROR );
-      if( br->getThread() )   
-        Scheduler::instance()->wake( br->getThread() );
       request_list_ = br->getNextRequest();
       return;
     }
@@ -337,8 +344,6 @@ void ATADriver::serviceIRQ()
     {
       br->setStatus( BDRequest::BD_DONE );
       request_list_ = br->getNextRequest();
-      if( br->getThread() )
-        Scheduler::instance()->wake( br->getThread() );
     }
   }
   else if( br->getCmd() == BDRequest::BD_WRITE )
@@ -350,18 +355,12 @@ void ATADriver::serviceIRQ()
       br->setStatus( BDRequest::BD_DONE );
       debug(ATA_DRIVER, "serviceIRQ:Waking up thread!!\n");
       request_list_ = br->getNextRequest();
-
-      if( br->getThread() )
-        Scheduler::instance()->wake( br->getThread() );
-
     }
     else
     {
       if( !waitForController() )
       {
         br->setStatus( BDRequest::BD_ERROR );
-        if( br->getThread() )
-           Scheduler::instance()->wake( br->getThread() );
         request_list_ = br->getNextRequest();
         return;
       }
@@ -377,8 +376,6 @@ void ATADriver::serviceIRQ()
     blocks_done = br->getNumBlocks();
     br->setStatus( BDRequest::BD_ERROR );
     request_list_ = br->getNextRequest();
-    if( br->getThread() )
-      Scheduler::instance()->wake( br->getThread() );
   }
 
   debug(ATA_DRIVER, "serviceIRQ:Request handled!!\n");
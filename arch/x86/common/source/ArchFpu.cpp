@@ -0,0 +1,180 @@
+#include "ArchFpu.h"
+#include "ArchThreads.h"
+#include "ArchInterrupts.h"
+#include "kprintf.h"
+#include "kstring.h"
+#include "assert.h"
+
+#define CR0_MP (1 << 1)
+#define CR0_EM (1 << 2)
+#define CR0_TS (1 << 3)
+#define CR4_OSFXSR (1 << 9)
+#define CR4_OSXMMEXCPT (1 << 10)
+#define CR4_OSXSAVE (1 << 18)
+
+#define CPUID_EDX_FXSR (1 << 24)
+#define CPUID_ECX_XSAVE (1 << 26)
+#define CPUID_ECX_AVX (1 << 28)
+
+#define XCR0_X87 (1 << 0)
+#define XCR0_SSE (1 << 1)
+#define XCR0_AVX (1 << 2)
+#define XSAVE_FEATURES (XCR0_X87 | XCR0_SSE | XCR0_AVX)
+
+#define FXSAVE_MXCSR_OFFSET 24
+#define MXCSR_DEFAULT 0x1F80
+#define FCW_DEFAULT 0x037F
+
+ArchFpu::SaveMode ArchFpu::save_mode_ = ArchFpu::FNSAVE;
+bool ArchFpu::save_mode_detected_ = false;
+ArchThreadInfo* ArchFpu::owner_ = 0;
+
+static void cpuid(uint32 leaf, uint32 subleaf, uint32& eax, uint32& ebx, uint32& ecx, uint32& edx)
+{
+  asm volatile("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(leaf), "c"(subleaf));
+}
+
+static size_t readCR0()
+{
+  size_t cr0;
+  asm volatile("mov %%cr0, %0" : "=r"(cr0));
+  return cr0;
+}
+
+static void writeCR0(size_t cr0)
+{
+  asm volatile("mov %0, %%cr0" : : "r"(cr0));
+}
+
+void ArchFpu::detectSaveMode()
+{
+  if (save_mode_detected_)
+    return;
+  save_mode_detected_ = true;
+
+  uint32 eax, ebx, ecx, edx;
+  cpuid(1, 0, eax, ebx, ecx, edx);
+  if ((ecx & CPUID_ECX_XSAVE) && (ecx & CPUID_ECX_AVX))
+  {
+    uint32 avx_size, avx_offset, unused_ecx, unused_edx;
+    cpuid(0xD, 2, avx_size, avx_offset, unused_ecx, unused_edx);
+    if (avx_offset + avx_size <= FPU_STATE_SIZE)
+    {
+      save_mode_ = XSAVE;
+      return;
+    }
+  }
+  save_mode_ = (edx & CPUID_EDX_FXSR) ? FXSAVE : FNSAVE;
+}
+
+void ArchFpu::initialise()
+{
+  detectSaveMode();
+
+  writeCR0((readCR0() | CR0_MP) & ~(CR0_EM | CR0_TS));
+  if (save_mode_ != FNSAVE)
+  {
+    size_t cr4;
+    asm volatile("mov %%cr4, %0" : "=r"(cr4));
+    cr4 |= CR4_OSFXSR | CR4_OSXMMEXCPT;
+    if (save_mode_ == XSAVE)
+      cr4 |= CR4_OSXSAVE;
+    asm volatile("mov %0, %%cr4" : : "r"(cr4));
+  }
+  if (save_mode_ == XSAVE)
+    asm volatile("xsetbv" : : "c"(0), "a"(XSAVE_FEATURES), "d"(0));
+  asm volatile("fninit");
+  owner_ = 0;
+
+  debug(A_COMMON, "FPU registers are switched lazily using %s\n",
+        save_mode_ == XSAVE ? "xsave" : save_mode_ == FXSAVE ? "fxsave" : "fnsave");
+}
+
+uint8* ArchFpu::alignedState(ArchThreadInfo* info)
+{
+  return (uint8*) (((pointer) info->fpu_state + FPU_STATE_ALIGNMENT - 1) & ~((pointer) FPU_STATE_ALIGNMENT - 1));
+}
+
+void ArchFpu::createState(ArchThreadInfo* info)
+{
+  detectSaveMode();
+  info->fpu_state = new uint8[FPU_STATE_SIZE + FPU_STATE_ALIGNMENT];
+  uint8* state = alignedState(info);
+  memset(state, 0, FPU_STATE_SIZE);
+
+  if (save_mode_ == FNSAVE)
+  {
+    /* fpu (=fninit) */
+    uint32* fpu = (uint32*) state;
+    fpu[0] = 0xFFFF037F;
+    fpu[1] = 0xFFFF0000;
+    fpu[2] = 0xFFFFFFFF;
+    fpu[6] = 0xFFFF0000;
+  }
+  else
+  {
+    // the abridged tag word is 0 (all registers empty), an all zero xsave header
+    // makes xrstor load the init state of the other components
+    *(uint16*) state = FCW_DEFAULT;
+    *(uint32*) (state + FXSAVE_MXCSR_OFFSET) = MXCSR_DEFAULT;
+  }
+}
+
+void ArchFpu::destroyState(ArchThreadInfo* info)
+{
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  if (owner_ == info)
+    owner_ = 0;
+  if (interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
+  delete[] info->fpu_state;
+  info->fpu_state = 0;
+}
+
+void ArchFpu::switchTo(ArchThreadInfo* info)
+{
+  if (info == owner_)
+    asm volatile("clts");
+  else
+    writeCR0(readCR0() | CR0_TS);
+}
+
+void ArchFpu::save(uint8* state)
+{
+  if (save_mode_ == XSAVE)
+    asm volatile("xsave (%0)" : : "r"(state), "a"(XSAVE_FEATURES), "d"(0) : "memory");
+  else if (save_mode_ == FXSAVE)
+    asm volatile("fxsave (%0)" : : "r"(state) : "memory");
+  else
+    asm volatile("fnsave (%0)" : : "r"(state) : "memory");
+}
+
+void ArchFpu::restore(uint8* state)
+{
+  if (save_mode_ == XSAVE)
+    asm volatile("xrstor (%0)" : : "r"(state), "a"(XSAVE_FEATURES), "d"(0) : "memory");
+  else if (save_mode_ == FXSAVE)
+    asm volatile("fxrstor (%0)" : : "r"(state) : "memory");
+  else
+    asm volatile("frstor (%0)" : : "r"(state) : "memory");
+}
+
+void ArchFpu::handleDeviceNotAvailable()
+{
+  asm volatile("clts");
+  if (owner_ == currentThreadInfo)
+    return;
+  if (owner_)
+    save(alignedState(owner_));
+  if (currentThreadInfo->fpu_state)
+  {
+    restore(alignedState(currentThreadInfo));
+    owner_ = currentThreadInfo;
+  }
+  else
+  {
+    // the dummy thread info used before the scheduler starts has no save area
+    asm volatile("fninit");
+    owner_ = 0;
+  }
+}
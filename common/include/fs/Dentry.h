@@ -162,6 +162,15 @@ class Dentry
     Dentry(const char* name);
     Dentry(Dentry *parent);
     virtual ~Dentry();
+
+#ifndef EXE2MINIXFS
+    /**
+     * Dentries are allocated from a SlabCache
+     */
+    static void* operator new(size_t size);
+    static void operator delete(void* address, size_t size);
+#endif
+
     ustl::string d_name_;
 };
 
@@ -2,12 +2,15 @@
 #define FILEDESCRIPTOR_H__
 
 #include "types.h"
-#include "ulist.h"
+#include "RCUList.h"
 
 class File;
 class FileDescriptor;
 
-extern ustl::list<FileDescriptor*> global_fd;
+/**
+ * all open file descriptors, read without a lock (see RCUList), add() and remove() serialize the writers
+ */
+extern RCUList<FileDescriptor*> global_fd;
 
 /**
  * @class FileDescriptor
@@ -37,6 +40,14 @@ class FileDescriptor
      */
     virtual ~FileDescriptor() {}
 
+#ifndef EXE2MINIXFS
+    /**
+     * FileDescriptors are allocated from a SlabCache
+     */
+    static void* operator new(size_t size);
+    static void operator delete(void* address, size_t size);
+#endif
+
     /**
      * get the file descriptor
      * @return the fd
@@ -60,6 +71,12 @@ class FileDescriptor
      * @param fd
      */
     static void remove(FileDescriptor* fd);
+
+    /**
+     * deletes the fd as soon as no reader of the global fd list can see it any longer
+     * @param fd an fd which has been removed from the global fd list
+     */
+    static void destroy(FileDescriptor* fd);
 };
 
 #endif // FILEDESCRIPTOR_H_
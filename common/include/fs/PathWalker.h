@@ -85,6 +85,11 @@ enum
  * this class illustrate how the VFS derives an inode from the corresponding
  * file pathname. Pathname lookup is performed by three methods: pathInit(),
  * pathWalk() and pathRelease().
+ *
+ * The dentry tree and the mounts are protected by the RWLock vfs_lock (defined in PathWalker.cpp).
+ * Lookups hold it for reading, so they run in parallel, everything which adds or removes dentries
+ * or mounts holds it for writing. pathWalk() does not take it itself, the caller has to hold it
+ * (at least for reading) as long as it uses the dentry found.
  */
 class PathWalker
 {
@@ -26,6 +26,14 @@ class VfsSyscall
      */
     static int32 dupChecking(const char* pathname, Dentry*& pw_dentry, VfsMount*& pw_vfs_mount);
 
+    /**
+     * opens the file of an existing dentry, the vfs_lock has to be held
+     * @param dentry the dentry of the file
+     * @param flag see open()
+     * @return the file descriptor, -1 if the dentry is not a file
+     */
+    static int32 openDentry(Dentry* dentry, uint32 flag);
+
   public:
 
     /**
@@ -7,6 +7,7 @@
 
 #include "types.h"
 #include <ustl/ulist.h>
+#include "RCUList.h"
 
 /**
  * File system flag indicating if the system in question requires an device.
@@ -39,13 +40,15 @@ class VirtualFileSystem
 
     /**
      * List of mounted Filesystems
+     * read without a lock, changed holding vfs_lock for writing
      */
-    ustl::list<VfsMount*> mounts_;
+    RCUList<VfsMount*> mounts_;
 
     /**
-     * A null-terminated array of file system types.
+     * The registered file system types.
+     * read without a lock, changed holding vfs_lock for writing
      */
-    ustl::list<FileSystemType*> file_system_types_;
+    RCUList<FileSystemType*> file_system_types_;
 
   public:
     void initialize();
@@ -0,0 +1,53 @@
+/**
+ * @file LockStatisticsInode.h
+ */
+
+#ifndef LOCK_STATISTICS_INODE_H__
+#define LOCK_STATISTICS_INODE_H__
+
+#include "fs/ramfs/RamFSInode.h"
+
+/**
+ * the maximum size of the generated report
+ */
+#define LOCK_STATISTICS_REPORT_SIZE 2048
+
+/**
+ * @class LockStatisticsInode
+ * The read only pseudo file /dev/lockstat, reading it returns the contention report of the
+ * most contended locks (see Lock::writeContentionStatistics()) as of the time of reading.
+ */
+class LockStatisticsInode : public RamFSInode
+{
+  public:
+
+    /**
+     * constructor
+     * @param super_block the superblock of the device file system
+     */
+    LockStatisticsInode(Superblock *super_block);
+
+    /**
+     * the inode is a file, it is linked like one
+     * @param dentry the dentry of the file
+     * @return 0 on success
+     */
+    virtual int32 mknod(Dentry *dentry);
+
+    /**
+     * generates the report and copies the requested part of it
+     * @param offset the offset into the report
+     * @param size the maximum number of bytes to read
+     * @param buffer the buffer to copy to
+     * @return the number of bytes read
+     */
+    virtual int32 readData(uint32 offset, uint32 size, char *buffer);
+
+    /**
+     * the file cannot be written
+     * @return -1
+     */
+    virtual int32 writeData(uint32 offset, uint32 size, const char *buffer);
+};
+
+#endif
@@ -57,6 +57,14 @@ class MinixFSInode : public Inode
      */
     virtual ~MinixFSInode();
 
+#ifndef EXE2MINIXFS
+    /**
+     * The inodes are allocated from a SlabCache
+     */
+    static void* operator new(size_t size);
+    static void operator delete(void* address, size_t size);
+#endif
+
     /**
      * lookup checks if that name (given by the char-array) exists in the
      * directory (I_DIR inode) and returns the Dentry if it does.
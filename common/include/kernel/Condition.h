@@ -2,6 +2,7 @@
 #define CONDITION__
 
 #include "Lock.h"
+#include "WaitQueue.h"
 
 class Thread;
 class Mutex;
@@ -17,6 +18,8 @@ class Mutex;
  * mixing lock and switching of interrupts wont work -> irq during time I have lock
  * only way: interrupts off or same lock
  * and interrupts off we want to avoid
+ *
+ * The sleepers are kept on a WaitQueue, the Mutex is released by it as soon as the thread is queued.
  */
 class Condition : public Lock
 {
@@ -42,6 +45,15 @@ class Condition : public Lock
      */
     void wait(const char* debug_info = 0, bool re_acquire_mutex = true);
 
+    /**
+     * Like wait, but the Thread wakes up again after the given number of timer ticks
+     * in case it has not been signaled meanwhile.
+     * The Mutex is re-acquired in both cases (if re_acquire_mutex is set).
+     * @param timeout_ticks the maximum number of ticks to wait
+     * @return true if the Thread has been signaled, false if the timeout expired
+     */
+    bool waitWithTimeout(size_t timeout_ticks, const char* debug_info = 0, bool re_acquire_mutex = true);
+
     /**
      * Wakes up the first Thread on the sleepers list.
      * If the list is empty, signal is being lost.
@@ -49,17 +61,28 @@ class Condition : public Lock
     void signal(const char* debug_info = 0);
 
     /**
-     * Wakes up all Threads on the sleepers list.
+     * Wakes up all Threads on the sleepers list, taking the whole list at once.
+     * Cheaper than calling signal() for each of them, they have to re-check their condition anyway.
      * If the list is empty, signal is being lost.
      */
     void broadcast(const char* debug_info = 0);
 
   private:
+    /**
+     * the checks done by wait and waitWithTimeout before going to sleep
+     */
+    void checkBeforeSleeping(const char* debug_info);
+
     /**
      * The mutex which is bound to this condition.
      */
     Mutex *mutex_;
 
+    /**
+     * The threads waiting on this condition.
+     */
+    WaitQueue sleepers_;
+
 };
 
 #endif
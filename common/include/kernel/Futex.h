@@ -0,0 +1,79 @@
+#ifndef _FUTEX_H_
+#define _FUTEX_H_
+
+#include "types.h"
+#include "Mutex.h"
+
+/**
+ * number of hash buckets the waiting threads are distributed on
+ */
+#define FUTEX_HASH_BUCKETS 64
+
+struct FutexWaiter;
+
+/**
+ * @class Futex
+ * Lets user threads sleep on a 32 bit word in their address space (see sc_futex).
+ * Userspace synchronisation primitives change the word with atomic instructions and only call
+ * into the kernel when they have to wait or there might be threads to wake up.
+ *
+ * A futex is identified by the physical address of the word, so the same word reached through
+ * different virtual addresses is the same futex. The waiters are kept in FutexWaiter entries on the
+ * stack of the waiting threads, each linked into the bucket its key hashes to.
+ */
+class Futex
+{
+  public:
+    /**
+     * the futexes are created in startup(), before any thread can call this concurrently
+     */
+    static Futex* instance();
+
+    /**
+     * Puts the currentThread to sleep if the word at the user address still holds the expected value.
+     * The value is compared while holding the bucket lock, a wake() after changing the word is not lost.
+     * @param address the user address of the word, 4 byte aligned
+     * @param expected the value the word has to hold
+     * @return 0 after being woken up, -1 if the value differed or the address is invalid
+     */
+    ssize_t wait(pointer address, uint32 expected);
+
+    /**
+     * wakes up threads waiting on the word at the user address, the longest waiting first
+     * @param address the user address of the word, 4 byte aligned
+     * @param count the maximum number of threads to wake up
+     * @return the number of threads woken up, -1 if the address is invalid
+     */
+    ssize_t wake(pointer address, size_t count);
+
+  private:
+    Futex();
+
+    class Bucket
+    {
+      public:
+        Bucket();
+
+        Mutex lock_;
+
+        /**
+         * the waiters in the order they started waiting, linked by FutexWaiter::next_
+         */
+        FutexWaiter* head_;
+        FutexWaiter* tail_;
+    };
+
+    /**
+     * computes the physical address of the word, the page is loaded if it is not mapped yet
+     * @return false if the address is no valid futex address of the currentThread
+     */
+    static bool getKey(pointer address, uint64& key);
+
+    Bucket& bucketOf(uint64 key);
+
+    Bucket buckets_[FUTEX_HASH_BUCKETS];
+
+    static Futex* instance_;
+};
+
+#endif
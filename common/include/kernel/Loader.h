@@ -78,6 +78,13 @@ class Loader
 
     bool readFromBinary (char* buffer, l_off_t position, size_t count);
 
+    /**
+     * maps a huge page for the region around virtual_address if the whole region is .bss,
+     * i.e. nothing of it comes from the file
+     * @return true if the huge page was mapped, false if the page has to be loaded on its own
+     */
+    bool loadHugePage(pointer virtual_address);
+
 
     size_t fd_;
     Thread *thread_;
@@ -2,9 +2,30 @@
 #define __LOCK_H__
 
 #include "types.h"
+#include "Atomic.h"
 
 class Thread;
 
+/**
+ * set to 0 to compile out the contention statistics of the locks (see Lock::printContentionStatistics())
+ */
+#ifndef LOCK_STATISTICS
+#define LOCK_STATISTICS 1
+#endif
+
+/**
+ * number of locks shown in the contention report
+ */
+#define LOCK_STATISTICS_TOP_N 10
+
+/**
+ * set to 0 to compile out the deadlock checks (see Lock::checkForDeadLock()),
+ * usually set by cmake (-DLOCKDEP=0)
+ */
+#ifndef LOCKDEP
+#define LOCKDEP 1
+#endif
+
 /**
  * This call represents the locks which are used to synchronize the kernel.
  */
@@ -12,6 +33,7 @@ class Lock
 {
 public:
   friend class Scheduler;
+  friend class LockDep;
 
   Lock(const char* name);
 
@@ -39,6 +61,59 @@ public:
    */
   static void printHoldingList(Thread* thread);
 
+  /**
+   * The contention statistics of a lock, all times in cycles (ArchCommon::getCycleCount()).
+   * A contended acquisition is one which could not get the lock right away,
+   * the wait time is the time from the first attempt until the lock was acquired.
+   * The Mutex also counts how its contended acquisitions ended (see WaitPath).
+   */
+  struct Statistics
+  {
+    Lock* lock;
+    const char* name;
+    uint64 acquisitions;
+    uint64 contended_acquisitions;
+    uint64 wait_cycles;
+    uint64 max_wait_cycles;
+    uint64 hold_cycles;
+    uint64 max_hold_cycles;
+    uint64 spin_acquisitions;
+    uint64 yield_acquisitions;
+    uint64 sleep_acquisitions;
+  };
+
+  /**
+   * the way a contended acquisition got the lock, only told apart by the Mutex
+   */
+  enum WaitPath
+  {
+    WAIT_UNCOUNTED,
+    WAIT_SPIN,
+    WAIT_YIELD,
+    WAIT_SLEEP
+  };
+
+  /**
+   * Copies the statistics of the locks the threads waited on the longest in total.
+   * @param top the array receiving the statistics, sorted by the total wait time (longest first)
+   * @param count the size of the array
+   * @return the number of locks copied
+   */
+  static size_t getTopContention(Statistics* top, size_t count);
+
+  /**
+   * Prints the LOCK_STATISTICS_TOP_N most contended locks using kprintfd.
+   */
+  static void printContentionStatistics();
+
+  /**
+   * Writes the same report as printContentionStatistics() into a buffer (used for /dev/lockstat).
+   * @param buffer the buffer receiving the text, it is always null terminated
+   * @param size the size of the buffer
+   * @return the length of the text (without the terminating null)
+   */
+  static size_t writeContentionStatistics(char* buffer, size_t size);
+
   Thread* heldBy() const
   {
     return held_by_;
@@ -72,11 +147,25 @@ protected:
    */
   Lock* next_lock_on_holding_list_;
 
+  /**
+   * true if the holder inherits the priority of the threads waiting for the lock
+   * (see Scheduler::inheritPriority()), false by default
+   */
+  bool priority_inheritance_;
+
   /**
    * Remove the current thread from the holding list.
    */
   void removeCurrentThreadFromWaitersList();
 
+  /**
+   * Remove the current thread from the waiters list in case it is still on it,
+   * i.e. nobody woke it up before the timeout of a timed wait expired.
+   * The waiters list has to be locked.
+   * @return true in case the thread was still on the list
+   */
+  bool removeCurrentThreadFromWaitersListIfWaiting();
+
   inline bool threadsAreOnWaitersList() const
   {
     return waiters_list_;
@@ -94,7 +183,9 @@ protected:
 
   /**
    * Check if a deadlock would happen in case the current thread would wait for this lock.
-   * The circular check is done within this lock.
+   * As long as the locks are taken in an order known to be consistent (see LockDep) this is
+   * a hash table lookup per held lock, otherwise the circular check is done within this lock.
+   * Compiled out with LOCKDEP set to 0.
    * @param debug_info Additional debug information
    */
   void checkForDeadLock(const char* debug_info = (const char*)0);
@@ -147,7 +238,7 @@ protected:
    */
   inline bool waitersListIsLocked() const
   {
-    return waiters_list_lock_;
+    return waiters_list_lock_.load(MEMORY_ORDER_RELAXED);
   }
 
   /**
@@ -162,6 +253,26 @@ protected:
    */
   void pushFrontCurrentThreadToWaitersList();
 
+  /**
+   * Has to be called when the first attempt to get the lock failed.
+   * @return the cycle count to pass to recordAcquisition() (0 with LOCK_STATISTICS disabled)
+   */
+  uint64 contentionStart();
+
+  /**
+   * Updates the statistics after the lock has been acquired, has to be called holding the lock
+   * (or, for shared holders, the waiters list).
+   * @param wait_start the return value of contentionStart(), 0 if the lock was acquired right away
+   * @param exclusive true if the hold time is measured until recordRelease()
+   * @param path how the lock was acquired in case it was contended
+   */
+  void recordAcquisition(uint64 wait_start, bool exclusive = true, WaitPath path = WAIT_UNCOUNTED);
+
+  /**
+   * Updates the hold time statistics, has to be called before the lock is released.
+   */
+  void recordRelease();
+
 private:
 
   /**
@@ -182,7 +293,29 @@ private:
    * The lock for the waiters list. The list has to be locked for writing access,
    * but may be used for unlocked access in case no element is going to be removed meanwhile.
    */
-  size_t waiters_list_lock_;
+  Atomic<size_t> waiters_list_lock_;
+
+  /**
+   * the counters reported by getTopContention(), the lock and name members are not used
+   */
+  Statistics statistics_;
+
+  /**
+   * the cycle count when the current exclusive holder acquired the lock
+   */
+  uint64 acquired_cycles_;
+
+  /**
+   * all constructed locks in a double chained list, for the contention report
+   */
+  Lock* next_lock_;
+  Lock* previous_lock_;
+  static Lock* all_locks_;
+
+  /**
+   * index + 1 of the lock class in the LockDep tables, 0 until the lock is checked the first time
+   */
+  size_t lock_class_;
 
   /**
    * Check if a deadlock would happen in combination with other locks.
@@ -0,0 +1,131 @@
+#ifndef _LOCK_DEP_H_
+#define _LOCK_DEP_H_
+
+#include "types.h"
+
+class Lock;
+
+/**
+ * the maximum number of lock classes (distinct lock names) and orders between them
+ */
+#define LOCKDEP_MAX_CLASSES 256
+#define LOCKDEP_MAX_ORDERS 1024
+
+/**
+ * size of the hash table of the orders, a power of two
+ */
+#define LOCKDEP_HASH_SIZE 2048
+
+/**
+ * @class LockDep
+ * Graph of the order in which locks are taken, used instead of walking the holding and waiting
+ * lists of all threads on every contended acquisition (see Lock::checkForDeadLock()).
+ *
+ * Locks with the same name form a lock class. Every time a thread waits for a lock while holding
+ * others, the pairs (held class, acquiring class) are looked up in a hash table. A new pair is
+ * validated once: if the graph already has a path back from the acquiring to the held class,
+ * the locks are taken in inconsistent orders, which can deadlock. The pair is reported and, like its
+ * reverse and every order on the path found, marked as needing the walk: waiting for locks in any order
+ * of the cycle is checked precisely from then on.
+ *
+ * The tables are static, no memory has to be allocated while acquiring locks. They are modified
+ * with interrupts disabled.
+ */
+class LockDep
+{
+  public:
+    /**
+     * checks the order of the locks held by the currentThread against the lock it is going to wait for
+     * @param holding_list the holding list of the currentThread
+     * @param acquiring the lock the currentThread is going to wait for
+     * @return true if the locks are known to be taken in a consistent order,
+     *         false if the caller has to check for a deadlock itself (inverted order, nested locks of
+     *         the same class or the tables are full)
+     */
+    static bool checkOrder(Lock* holding_list, Lock* acquiring);
+
+    /**
+     * prints the number of lock classes, orders and inversions found so far
+     */
+    static void printStatistics();
+
+  private:
+    struct LockClass
+    {
+        const char* name;
+        uint32 hash;
+
+        /**
+         * index + 1 of the first order starting at this class, 0 if none
+         */
+        uint16 first_order;
+    };
+
+    struct LockOrder
+    {
+        uint16 from;
+        uint16 to;
+
+        /**
+         * index + 1 of the next order starting at the same class, 0 if none
+         */
+        uint16 next_order;
+
+        /**
+         * the order is part of a cycle, waiting in this order has to be checked by walking the threads
+         */
+        bool needs_walk;
+    };
+
+    /**
+     * @return the index + 1 of the class of the lock, 0 if the class table is full
+     */
+    static size_t getClass(Lock* lock);
+
+    /**
+     * @return true if the pair is in a consistent order, see checkOrder()
+     */
+    static bool checkPair(size_t from, size_t to);
+
+    /**
+     * @return the index + 1 of the order, 0 if it is not known yet
+     */
+    static size_t findOrder(size_t from, size_t to);
+
+    /**
+     * marks the order, if it is known, as needing the walk
+     */
+    static void markNeedsWalk(size_t from, size_t to);
+
+    /**
+     * depth first search through the orders
+     * @return true if there is a path from the class start to the class target
+     */
+    static bool hasPath(size_t start, size_t target);
+
+    static void printPath(size_t start, size_t target);
+
+    static LockClass classes_[LOCKDEP_MAX_CLASSES];
+    static size_t num_classes_;
+
+    static LockOrder orders_[LOCKDEP_MAX_ORDERS];
+    static size_t num_orders_;
+    static size_t num_inversions_;
+
+    /**
+     * open addressing hash table of the orders, index + 1 into orders_, 0 if empty
+     */
+    static uint16 order_hash_[LOCKDEP_HASH_SIZE];
+
+    /**
+     * state of the depth first search, a class is visited if its entry equals search_generation_
+     */
+    static uint32 visited_[LOCKDEP_MAX_CLASSES];
+    static uint16 parent_[LOCKDEP_MAX_CLASSES];
+    static uint16 search_stack_[LOCKDEP_MAX_CLASSES];
+    static uint32 search_generation_;
+
+    static bool full_reported_;
+};
+
+#endif
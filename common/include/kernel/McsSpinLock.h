@@ -0,0 +1,100 @@
+#ifndef _MCS_SPINLOCK_H_
+#define _MCS_SPINLOCK_H_
+
+#include "types.h"
+#include "Atomic.h"
+
+class Thread;
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+/**
+ * the queue entry of a thread holding or waiting for an McsSpinLock,
+ * usually a local variable of the function taking the lock
+ */
+struct McsNode
+{
+    Atomic<McsNode*> next;
+    Atomic<size_t> locked;
+} __attribute__((aligned(CACHE_LINE_SIZE)));
+
+/**
+ * @class McsSpinLock
+ * A fair busy waiting lock which scales with contention (Mellor-Crummey and Scott).
+ *
+ * The waiters form a queue of McsNodes, the lock itself only points to the last one (tail_).
+ * Each waiter spins on the locked flag in its own node, which lives in its own cache line, and
+ * is handed the lock by its predecessor. So the waiters do not bounce a shared cache line around
+ * like with the TicketSpinLock, which makes it the better choice for heavily contended locks.
+ *
+ * The node has to stay valid from acquire() to release() and is passed to both, e.g.
+ *   McsNode node;
+ *   lock.acquire(node);
+ *   ...
+ *   lock.release(node);
+ *
+ * Like the TicketSpinLock it may be used with interrupts disabled and from interrupt handlers,
+ * in which case it has to be taken with acquireIrqSave() everywhere.
+ */
+class McsSpinLock
+{
+  public:
+    McsSpinLock(const char* name);
+
+    /**
+     * enqueues the node and waits until the predecessor hands the lock over
+     * @param node the queue entry of the currentThread
+     */
+    void acquire(McsNode& node);
+
+    /**
+     * takes the lock only if nobody holds or waits for it
+     * @param node the queue entry of the currentThread
+     * @return true if the lock has been acquired
+     */
+    bool acquireNonBlocking(McsNode& node);
+
+    /**
+     * hands the lock over to the successor of the node, if any
+     * @param node the node passed to acquire
+     */
+    void release(McsNode& node);
+
+    /**
+     * disables the interrupts and acquires the lock
+     * @return whether the interrupts were enabled before, to be passed to releaseIrqRestore()
+     */
+    bool acquireIrqSave(McsNode& node);
+
+    /**
+     * releases the lock and enables the interrupts again if they were enabled before acquireIrqSave()
+     */
+    void releaseIrqRestore(McsNode& node, bool interrupts_enabled);
+
+    /**
+     * only meaningful if the result can not change meanwhile (e.g. with interrupts disabled on a single CPU)
+     */
+    bool isFree();
+
+    const char* getName() const
+    {
+      return name_;
+    }
+
+  private:
+    McsSpinLock(McsSpinLock const &);
+    McsSpinLock &operator=(McsSpinLock const&);
+
+    const char* name_;
+
+    /**
+     * the McsNode of the last thread in the queue, 0 if the lock is free
+     */
+    Atomic<McsNode*> tail_;
+
+    Thread* held_by_;
+};
+
+#endif
@@ -5,6 +5,12 @@
 #include "MutexLock.h"
 #include "Lock.h"
 class Thread;
+class Timer;
+
+/**
+ * the maximum number of iterations a thread spins on a mutex whose holder is running
+ */
+#define MUTEX_SPIN_ITERATIONS 1000
 
 /**
  * @class Mutex
@@ -13,6 +19,15 @@ class Thread;
  * it puts itself onto the waiters list and goes to sleep.
  * Whenever a thread holding the mutex is going to release it,
  * it wakes up a thread waiting on this mutex.
+ *
+ * The mutex is adaptive: most critical sections are short, so a sleep, context switch and
+ * wake up cost more than waiting for the holder. As long as the holder is running on another
+ * CPU the thread spins (at most MUTEX_SPIN_ITERATIONS times). The kernel runs on a single CPU
+ * though, so the holder is never running while another thread tries to acquire the mutex and
+ * the spinning is not done yet. What is done instead: in case the holder has been preempted
+ * within its critical section and is runnable, the thread yields once to let it finish.
+ * Only if the mutex is still held then, the thread goes to sleep.
+ * How often each way succeeded is part of the contention statistics (see Lock::Statistics).
  */
 class Mutex: public Lock
 {
@@ -38,6 +53,13 @@ public:
    */
   void acquire(const char* debug_info = (const char*)0);
 
+  /**
+   * like acquire, but gives up after waiting for the given number of timer ticks
+   * @param timeout_ticks the maximum number of ticks to wait for the Lock
+   * @return true if the Lock was acquired, false if the timeout expired
+   */
+  bool acquireWithTimeout(size_t timeout_ticks, const char* debug_info = (const char*)0);
+
   /**
    * release frees the Lock. It must be called at the end of
    * a critical region, allowing other threads to execute code
@@ -58,12 +80,26 @@ public:
 
 private:
 
+  /**
+   * the adaptive part of acquire, tries to get the held mutex without going to sleep
+   * @param path set to the way the mutex has been acquired
+   * @return true if the mutex has been acquired
+   */
+  bool acquireWithoutSleeping(WaitPath& path);
+
+  /**
+   * the implementation of acquire and acquireWithTimeout
+   * @param timeout the timer ending the wait, 0 to wait until the Lock is free
+   * @return false if the timeout expired
+   */
+  bool doAcquire(const char* debug_info, Timer* timeout);
+
   /**
    * The basic mutex.
    * It is atomic set to 1 when acquired,
    * and set to 0 when the mutex is released.
    */
-  size_t mutex_;
+  Atomic<size_t> mutex_;
 
   /**
    * Copy Constructor, but private.
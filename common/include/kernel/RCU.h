@@ -0,0 +1,152 @@
+#ifndef _RCU_H_
+#define _RCU_H_
+
+#include "types.h"
+#include "McsSpinLock.h"
+
+/**
+ * an entry of the list of deferred frees, usually embedded into the memory which is freed
+ */
+struct RCUHead
+{
+    RCUHead* next_;
+    void (*reclaim_)(RCUHead* head);
+};
+
+/**
+ * @class RCU
+ * Read-copy-update for read-mostly data. Readers do not take any lock, they only mark their
+ * read-side critical section (see RCUReadLock). A writer publishes a new version of the data
+ * (see RCUList) and hands the old one to call() or deferDelete(). It is freed by the CleanupThread
+ * after a grace period, i.e. as soon as no reader which might still see it is left.
+ *
+ * Readers may sleep, so a context switch does not end a read-side critical section. Instead the
+ * readers are counted in one of two phases: a grace period flips the phase new readers enter and
+ * is over once the readers of the old phase are gone. Scheduler::schedule() checks this as its
+ * quiescent state, neither readers nor writers ever wait for a grace period.
+ *
+ * Readers enter and leave from interrupt handlers as well, so the reader counts and the lists of
+ * frees are protected by lock_, taken with acquireIrqSave() outside of schedule().
+ */
+class RCU
+{
+  public:
+    static RCU* instance();
+
+    /**
+     * enters a read-side critical section of the currentThread, may be nested
+     */
+    void readLock();
+
+    /**
+     * leaves the read-side critical section entered by the matching readLock()
+     */
+    void readUnlock();
+
+    /**
+     * Calls reclaim(head) from the CleanupThread after a grace period has passed.
+     * Only the free is deferred, concurrent writers have to be serialized by a lock of their own.
+     * @param head the entry, it must stay valid until reclaim is called
+     * @param reclaim the function freeing the memory
+     */
+    void call(RCUHead* head, void (*reclaim)(RCUHead* head));
+
+    /**
+     * deletes the object after a grace period, see call()
+     */
+    template<typename T>
+    void deferDelete(T* object)
+    {
+      DeleteEntry<T>* entry = new DeleteEntry<T>();
+      entry->object_ = object;
+      call(&entry->head_, &DeleteEntry<T>::reclaim);
+    }
+
+    /**
+     * Called by Scheduler::schedule() with interrupts disabled. Ends the current grace period in case
+     * the readers of its phase are gone and starts the next one for the frees queued meanwhile.
+     */
+    void quiescentState();
+
+    /**
+     * runs the reclaim functions of the grace periods which have passed,
+     * called by the CleanupThread which got a job for each of them
+     */
+    void reclaim();
+
+  private:
+    RCU();
+
+    template<typename T>
+    struct DeleteEntry
+    {
+        RCUHead head_;
+        T* object_;
+
+        static void reclaim(RCUHead* head)
+        {
+          DeleteEntry* entry = (DeleteEntry*) head;
+          delete entry->object_;
+          delete entry;
+        }
+    };
+
+    /**
+     * starts a grace period for the frees queued since the last one, if there are any
+     */
+    void startGracePeriod();
+
+    /**
+     * the phase new readers enter, the number of readers in each phase
+     */
+    size_t phase_;
+    size_t readers_[2];
+
+    /**
+     * the frees waiting for the current grace period (0 if none is running) and the phase it waits for
+     */
+    RCUHead* current_;
+    size_t grace_period_phase_;
+
+    /**
+     * the frees queued while a grace period is running, they wait for the next one
+     */
+    RCUHead* next_;
+
+    /**
+     * the frees whose grace period has passed and the number of grace periods they belong to
+     */
+    RCUHead* done_;
+    size_t done_grace_periods_;
+
+    /**
+     * every reader takes it twice, an McsSpinLock keeps the waiters off each other's cache lines
+     */
+    McsSpinLock lock_;
+
+    static RCU* instance_;
+};
+
+/**
+ * @class RCUReadLock
+ * a read-side critical section for the lifetime of the object
+ */
+class RCUReadLock
+{
+  public:
+    RCUReadLock()
+    {
+      RCU::instance()->readLock();
+    }
+
+    ~RCUReadLock()
+    {
+      RCU::instance()->readUnlock();
+    }
+
+  private:
+    RCUReadLock(RCUReadLock const&);
+    RCUReadLock &operator=(RCUReadLock const&);
+};
+
+#endif
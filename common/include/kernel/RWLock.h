@@ -0,0 +1,106 @@
+#ifndef _RWLOCK_H_
+#define _RWLOCK_H_
+
+#include "types.h"
+#include "Lock.h"
+class Thread;
+
+/**
+ * @class RWLock
+ * A sleeping lock for read-mostly data, any number of readers or a single writer may hold it.
+ *
+ * The lock prefers writers: as soon as a writer waits, new readers have to wait as well, so a
+ * steady stream of readers can not starve it. For the same reason read locks must not be nested,
+ * the inner readAcquire() would wait for a writer waiting for the outer one.
+ *
+ * The writer is tracked like the holder of a Mutex (held_by_, holding list, deadlock checks).
+ * Readers are only counted, a lock can not be on the holding lists of several threads.
+ * The state of the lock is protected by the waiters list lock of the Lock base class.
+ */
+class RWLock: public Lock
+{
+public:
+
+  RWLock(const char* name);
+
+  /**
+   * waits until no writer holds or waits for the lock and takes it for reading
+   */
+  void readAcquire(const char* debug_info = (const char*)0);
+
+  void readRelease(const char* debug_info = (const char*)0);
+
+  /**
+   * waits until neither a writer nor readers hold the lock and takes it exclusively
+   */
+  void writeAcquire(const char* debug_info = (const char*)0);
+
+  void writeRelease(const char* debug_info = (const char*)0);
+
+  size_t getNumReaders() const
+  {
+    return readers_;
+  }
+
+private:
+
+  RWLock(RWLock const &);
+  RWLock &operator=(RWLock const&);
+
+  /**
+   * wakes up all waiting threads, they check again whether they may take the lock
+   * the waiters list has to be locked
+   */
+  void wakeWaiters();
+
+  size_t readers_;
+  size_t waiting_writers_;
+};
+
+/**
+ * holds an RWLock for reading as long as it exists
+ */
+class ScopedReadLock
+{
+  public:
+    ScopedReadLock(RWLock &lock) : lock_(lock)
+    {
+      lock_.readAcquire();
+    }
+
+    ~ScopedReadLock()
+    {
+      lock_.readRelease();
+    }
+
+  private:
+    ScopedReadLock(ScopedReadLock const&);
+    ScopedReadLock &operator=(ScopedReadLock const&);
+
+    RWLock &lock_;
+};
+
+/**
+ * holds an RWLock for writing as long as it exists
+ */
+class ScopedWriteLock
+{
+  public:
+    ScopedWriteLock(RWLock &lock) : lock_(lock)
+    {
+      lock_.writeAcquire();
+    }
+
+    ~ScopedWriteLock()
+    {
+      lock_.writeRelease();
+    }
+
+  private:
+    ScopedWriteLock(ScopedWriteLock const&);
+    ScopedWriteLock &operator=(ScopedWriteLock const&);
+
+    RWLock &lock_;
+};
+
+#endif
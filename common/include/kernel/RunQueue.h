@@ -0,0 +1,174 @@
+#ifndef _RUN_QUEUE_H_
+#define _RUN_QUEUE_H_
+
+#include "types.h"
+
+class Thread;
+
+/**
+ * number of priority levels known to the scheduler, 0 is the highest priority
+ * must not exceed the number of bits in RunQueue::occupied_levels_
+ */
+#define NUM_PRIORITIES 32
+#define DEFAULT_PRIORITY 16
+#define LOWEST_PRIORITY (NUM_PRIORITIES - 1)
+
+/**
+ * nice values (as in posix), they weight the virtual runtime of a thread
+ * a thread with nice value n gets about 1.25 times the CPU time of one with n + 1
+ */
+#define NICE_MIN (-20)
+#define NICE_MAX 19
+#define NICE_0_WEIGHT 1024
+
+/**
+ * number of priority levels of the real-time class, 0 is the highest priority
+ * level 0 is reserved for kernel workers (KERNEL_RT_PRIORITY), user processes get the levels below
+ */
+#define NUM_RT_PRIORITIES 32
+#define KERNEL_RT_PRIORITY 0
+
+/**
+ * scheduling classes, a runnable thread of a class always runs before the threads of the classes below
+ * (unless the real-time classes used up their share of the CPU time, see Scheduler::setScheduling())
+ * - SCHED_CLASS_DEADLINE: earliest deadline first, each thread gets a budget of CPU time per period
+ * - SCHED_CLASS_RT: fixed priority levels, round robin within a level
+ * - SCHED_CLASS_NORMAL: the priority levels above, sharing the CPU fairly within a level
+ */
+enum SchedulingClass
+{
+  SCHED_CLASS_DEADLINE, SCHED_CLASS_RT, SCHED_CLASS_NORMAL
+};
+
+/**
+ * for priority inheritance the classes and their levels are put onto a single scale, the rank
+ * (0: deadline, 1 to NUM_RT_PRIORITIES: real-time levels, then the normal levels), lower is more important
+ * NO_INHERITED_RANK: the thread does not inherit a priority, see Scheduler::inheritPriority()
+ */
+#define NO_INHERITED_RANK 0xFFFFFFFF
+
+/**
+ * @class RunQueue
+ * Holds the runnable threads, one queue per priority level.
+ * A bitmap keeps track of the non-empty levels, so finding the highest level
+ * with runnable threads is a single bit scan instead of a walk over all threads.
+ *
+ * Threads of the real-time classes are kept apart: the deadline threads in a single queue
+ * ordered by their deadline, the real-time threads in one queue per real-time priority level
+ * ordered by the time they were enqueued. Both go before all the threads of the normal class.
+ *
+ * Within a level the threads share the CPU fairly: each level is a pairing heap
+ * ordered by the virtual runtime of the threads (the CPU time they consumed, weighted
+ * by their nice value), the thread which got the least CPU time so far runs next.
+ * Threads which were not queued for a while (sleeping, new) are put to the current
+ * minimum virtual runtime of their level on enqueue, so they cannot monopolise the CPU.
+ *
+ * The queues are intrusive (linked through the Thread objects), therefore no
+ * memory is allocated here - important because it is used with interrupts disabled.
+ *
+ * The RunQueue itself does no locking, the caller has to ensure that it is not
+ * modified concurrently (i.e. interrupts have to be disabled).
+ */
+class RunQueue
+{
+  public:
+    RunQueue();
+
+    /**
+     * inserts the thread into the queue of its class (Thread::run_queue_class_) and priority level
+     * (Thread::run_queue_level_)
+     * does nothing if the thread is already queued
+     * @param thread the thread to enqueue
+     */
+    void enqueue(Thread* thread);
+
+    /**
+     * removes the thread from the queue it is on
+     * does nothing if the thread is not queued
+     * @param thread the thread to dequeue
+     */
+    void dequeue(Thread* thread);
+
+    /**
+     * removes and returns the thread with the earliest deadline, or if there is none the first thread
+     * of the highest non-empty real-time level, or the thread with the least virtual runtime of the
+     * highest non-empty normal priority level
+     * @param normal_first prefer the threads of the normal class to the real-time classes
+     * @return the thread, or 0 if no thread is queued
+     */
+    Thread* pickNext(bool normal_first = false);
+
+    bool isEmpty() const
+    {
+      return occupied_levels_ == 0 && occupied_rt_levels_ == 0 && deadline_heap_ == 0;
+    }
+
+    size_t size() const
+    {
+      return count_;
+    }
+
+    /**
+     * @param nice the nice value, NICE_MIN to NICE_MAX
+     * @return the weight of the nice value, NICE_0_WEIGHT for nice value 0
+     */
+    static uint32 niceToWeight(int32 nice);
+
+  private:
+    /**
+     * @return the root of the heap the thread belongs to
+     */
+    Thread*& heapOf(Thread* thread);
+
+    /**
+     * melds two heaps (their roots must not have siblings), ordered by Thread::run_queue_key_
+     * @return the root of the resulting heap
+     */
+    static Thread* meld(Thread* a, Thread* b);
+
+    /**
+     * melds a list of sibling heaps in two passes (pairwise from left to right,
+     * then the pairs from right to left), which keeps the pairing heap's amortized O(log n)
+     * @return the root of the resulting heap
+     */
+    static Thread* mergePairs(Thread* first);
+
+    /**
+     * the root of each level's heap, i.e. the thread with the least virtual runtime
+     */
+    Thread* heaps_[NUM_PRIORITIES];
+
+    /**
+     * the root of the heap of the deadline threads, i.e. the one with the earliest deadline
+     */
+    Thread* deadline_heap_;
+
+    /**
+     * the root of each real-time level's heap, i.e. the thread queued first
+     */
+    Thread* rt_heaps_[NUM_RT_PRIORITIES];
+
+    /**
+     * the virtual runtime of the thread picked last from each level, never decreases
+     */
+    uint64 min_vruntime_[NUM_PRIORITIES];
+
+    /**
+     * bit n is set if there is at least one thread on priority level n
+     */
+    uint32 occupied_levels_;
+
+    /**
+     * bit n is set if there is at least one thread on real-time level n
+     */
+    uint32 occupied_rt_levels_;
+
+    /**
+     * incremented on each enqueue of a real-time thread, orders the threads of a real-time level
+     */
+    uint64 rt_sequence_;
+
+    size_t count_;
+};
+
+#endif
@@ -9,11 +9,26 @@
 #include <ulist.h>
 #include "IdleThread.h"
 #include "CleanupThread.h"
+#include "RunQueue.h"
+#include "Thread.h"
+#include "Histogram.h"
+#include "Mutex.h"
+#include "RCUList.h"
 
 class Thread;
 class Mutex;
 class SpinLock;
 class Lock;
+class Timer;
+
+/**
+ * the real-time classes (deadline and real-time) together may use RT_BANDWIDTH_PERMILLE of the CPU time
+ * of each period of RT_PERIOD_TICKS ticks. Beyond that the threads of the normal class go first for the
+ * rest of the period, so real-time threads cannot starve the system.
+ * The deadline threads are admitted as long as the sum of their shares of the CPU stays within it.
+ */
+#define RT_PERIOD_TICKS 16
+#define RT_BANDWIDTH_PERMILLE 950
 
 
 /**
@@ -49,6 +64,22 @@ class Scheduler
      */
     void sleep();
 
+    /**
+     * puts the currentThread to sleep for the given number of timer ticks
+     * the thread may be woken up earlier by wake()
+     * @param ticks the number of ticks to sleep
+     */
+    void sleepFor(size_t ticks);
+
+    /**
+     * puts the currentThread to sleep and takes it off the run queue, used by WaitQueue
+     * has to be called with interrupts disabled, so a wake up from an interrupt handler cannot get lost
+     * in between. They are enabled while the thread sleeps and disabled again before returning.
+     * @param timeout a timer which wakes the thread up again, 0 to sleep until woken up.
+     *        In case it expired already, the thread does not go to sleep at all.
+     */
+    void sleepWithInterruptsDisabled(Timer *timeout = 0);
+
     /**
      * wakes up a sleeping thread
      * @param *thread_to_wake, Pointer to the Thread that will be woken up
@@ -60,6 +91,36 @@ class Scheduler
      */
     void yield();
 
+    /**
+     * puts the thread onto the run queue in case it is ready for scheduling,
+     * e.g. a worker thread which just got a new job
+     * may be called from an interrupt handler
+     * @param thread the thread which might have become runnable
+     */
+    void enqueueIfSchedulable(Thread *thread);
+
+    /**
+     * changes the nice value of a thread, i.e. its share of the CPU time compared
+     * to the other threads of its priority level
+     * @param thread the thread
+     * @param nice the new nice value, cut to the range NICE_MIN to NICE_MAX
+     */
+    void setNice(Thread *thread, int32 nice);
+
+    /**
+     * changes the scheduling class of a thread
+     * A woken up thread of a higher class preempts a thread of a lower class with the next timer tick.
+     * @param thread the thread
+     * @param sched_class the new scheduling class
+     * @param rt_priority SCHED_CLASS_RT: the real-time priority level, 0 (highest) to NUM_RT_PRIORITIES - 1
+     * @param runtime_ticks SCHED_CLASS_DEADLINE: the CPU time the thread gets in each period
+     * @param period_ticks SCHED_CLASS_DEADLINE: the length of a period, its end is the deadline of the thread
+     * @return false in case the parameters are invalid or a deadline thread is not admitted,
+     *         because the deadline threads would need more than RT_BANDWIDTH_PERMILLE of the CPU
+     */
+    bool setScheduling(Thread *thread, SchedulingClass sched_class, uint32 rt_priority = 0, size_t runtime_ticks = 0,
+                       size_t period_ticks = 0);
+
     /**
      * prints a List of all Threads using kprintfd
      */
@@ -80,14 +141,48 @@ class Scheduler
      */
     void printLockingInformation();
 
+    /**
+     * prints the latency statistics (in cycles) using kprintfd: the wake up latency of each thread
+     * (from wake() until it runs), the context switches, the duration of schedule(), the run queue
+     * lengths and the time the threads slept on locks
+     */
+    void printSchedulingStatistics();
+
     /**
      * Sleep on a lock and release the waiters list.
      * This operations have to be done when the scheduler is disabled,
      * else it may happen that a thread sleeps forever.
      * The thread is pushed onto the waiters list before.
      * @param lock The lock which shall be waiting on
+     * @param timeout A timer which wakes the thread up again, 0 to sleep until woken up.
+     *        In case it expired already, the thread does not go to sleep at all.
+     *        The caller has to cancel it after waking up and remove itself from the waiters list
+     *        in case it is still on it.
+     */
+    void sleepAndRelease ( Lock &lock, Timer *timeout = 0 );
+
+    /**
+     * Priority inheritance, called by the currentThread right before it sleeps on the lock.
+     * The holder of the lock runs at least with the rank of the currentThread until it releases
+     * its mutexes, the boost is passed on along Thread::lock_waiting_on_ in case the holder waits itself.
+     * Only locks with Lock::priority_inheritance_ set take part.
+     * @param lock the lock the currentThread is going to wait for
+     */
+    void inheritPriority(Lock *lock);
+
+    /**
+     * called by the currentThread after releasing a mutex, drops the inherited rank to the one of the
+     * most important thread still waiting for one of its mutexes
+     * (a waiter which stopped waiting due to a timeout keeps boosting the holder until then)
+     */
+    void restorePriority();
+
+    /**
+     * @param thread the thread
+     * @return true if the thread is executing on a CPU right now
+     *         (the kernel runs on a single CPU, so only the currentThread)
      */
-    void sleepAndRelease ( Lock &lock );
+    bool isRunning(Thread *thread);
 
     /**
      * Check if scheduling is enabled
@@ -100,12 +195,17 @@ class Scheduler
      * this is the method that decides which threads will be scheduled next
      * it is called by either the timer interrupt handler or the yield interrupt handler
      * and changes the global variables currentThread and currentThreadInfo
+     * the CPU time used by the previous thread is added to its virtual runtime
+     * @param yielding true if called by the yield interrupt handler, the currentThread is then
+     *        only chosen again if there is no other runnable thread
      * @return 1 if the InterruptHandler should switch to Usercontext or 0 if we can stay in Kernelcontext
      */
-    uint32 schedule();
+    uint32 schedule(bool yielding = false);
 
     /**
      * increments the stored ticks value by 1
+     * called by the timer interrupt handler, the first ticks are used to measure
+     * the length of a tick in cycles (needed to keep the ticks while the timer is stopped)
      */
     void incTicks();
 
@@ -114,12 +214,13 @@ class Scheduler
     friend class CleanupThread;
     /**
      * this method is periodically called by the idle-Thread
-     * it removes and deletes Threads in state ToBeDestroyed
+     * it removes Threads in state ToBeDestroyed, they are deleted after an RCU grace period
      */
     void cleanupDeadThreads();
 
     /**
      * returns the ticks value stored
+     * while the timer is stopped, the ticks which passed since then are added
      */
     uint32 getTicks();
     
@@ -141,13 +242,112 @@ class Scheduler
 
     static Scheduler *instance_;
 
-    typedef ustl::list<Thread*> ThreadList;
-    ThreadList threads_;
+    /**
+     * all threads known to the scheduler, used for cleanup and the debug prints
+     * schedule() does not walk this list, it only uses run_queue_
+     * read without a lock (see RCU), changed holding threads_lock_
+     */
+    RCUList<Thread*> threads_;
+    Mutex threads_lock_;
+
+    /**
+     * the runnable threads (except the currentThread and the idle thread)
+     * must only be accessed with interrupts disabled
+     */
+    RunQueue run_queue_;
+
+    /**
+     * dynamic tick: the timer interrupt is only needed to preempt the currentThread,
+     * so it is stopped while there is no other runnable thread (idle or a single thread
+     * owning the CPU) and started again as soon as a thread is enqueued.
+     * must be called with interrupts disabled
+     */
+    void startTick();
+    void stopTick();
+
+    /**
+     * @return a monotonic clock the CPU time of the threads is measured with
+     * (the cycle counter, or the ticks if the architecture has none)
+     */
+    uint64 runtimeClock();
+
+    /**
+     * adds the CPU time used since the last call to the virtual runtime of the thread,
+     * and for the real-time classes to the real-time CPU time and the budget of a deadline thread
+     */
+    void accountRuntime(Thread *thread);
+
+    /**
+     * @return the given number of ticks in units of runtimeClock(), 0 as long as this is not known
+     */
+    uint64 ticksToRuntimeClock(size_t ticks);
+
+    /**
+     * puts the thread onto its run queue, in the queue of the class it is entitled to at the moment
+     * must be called with interrupts disabled
+     */
+    void enqueue(Thread *thread);
+
+    /**
+     * @return the rank (see RunQueue.h) the thread was queued with the last time
+     */
+    static uint32 rankOf(Thread *thread);
+
+    /**
+     * @return true if the real-time classes used up their share of the current period, see RT_BANDWIDTH_PERMILLE
+     */
+    bool realTimeThrottled();
+
+    /**
+     * the share of the CPU reserved by the deadline threads, in permille
+     */
+    size_t dl_utilization_;
+
+    /**
+     * start (in units of runtimeClock()) and CPU time used by the real-time classes of the current RT_PERIOD_TICKS period
+     */
+    uint64 rt_period_start_;
+    uint64 rt_runtime_used_;
+
+    uint64 last_runtime_clock_;
 
     size_t block_scheduling_;
 
     size_t ticks_;
 
+    /**
+     * true while the timer interrupt is masked, see startTick()
+     */
+    bool tick_stopped_;
+
+    /**
+     * true while the timer interrupt the PIC latched during a stop is not delivered yet,
+     * incTicks() drops it
+     */
+    bool tick_latched_;
+
+    /**
+     * cycle count of the last tick accounted for in ticks_
+     */
+    uint64 last_tick_cycles_;
+
+    /**
+     * length of a tick in cycles, 0 as long as it is not measured
+     * (the tick is never stopped then)
+     */
+    uint64 cycles_per_tick_;
+
+    uint64 calibration_start_cycles_;
+
+    /**
+     * scheduler statistics, see printSchedulingStatistics()
+     */
+    Histogram schedule_cycles_;
+    Histogram run_queue_length_;
+    Histogram lock_sleep_cycles_;
+    uint64 context_switches_;
+    uint64 yields_;
+
     IdleThread idle_thread_;
     CleanupThread cleanup_thread_;
 };
@@ -58,7 +58,7 @@ class SpinLock : public Lock
     /**
      * The basic spinlock is just a variable which is
      */
-    size_t lock_;
+    Atomic<size_t> lock_;
 
     /**
      * Do not use the copy constructor of the spinlock!
@@ -112,6 +112,57 @@ class Syscall
  */
   static size_t createprocess(size_t path, size_t sleep);
 
+/**
+ * puts the calling thread to sleep for (at least) the given time,
+ * which is rounded up to whole timer ticks
+ *
+ * @pre IF==1
+ * @pre pointers < 2gb
+ * @param request pointer to a userspace struct timespec holding the time to sleep
+ * @param remaining pointer to a userspace struct timespec receiving the time not slept (always 0), may be 0
+ * @return -1 upon error, 0 otherwise
+ */
+  static size_t nanosleep(size_t request, size_t remaining);
+
+/**
+ * changes the nice value of the calling thread (its share of the CPU time)
+ *
+ * @pre IF==1
+ * @param increment the value added to the nice value (may be negative),
+ *        the result is cut to the range NICE_MIN to NICE_MAX
+ * @return the new nice value
+ */
+  static size_t nice(ssize_t increment);
+
+/**
+ * changes the scheduling policy of the calling thread
+ * real-time and deadline threads run before all other threads, as long as they do not
+ * use more than RT_BANDWIDTH_PERMILLE of the CPU time (see Scheduler::setScheduling())
+ *
+ * @pre IF==1
+ * @param policy SCHED_OTHER, SCHED_FIFO, SCHED_RR (both round robin within a priority level) or SCHED_DEADLINE
+ * @param priority SCHED_FIFO/SCHED_RR: 1 (lowest) to NUM_RT_PRIORITIES - 1 (highest)
+ * @param runtime_ms SCHED_DEADLINE: the CPU time granted in each period, in milliseconds
+ * @param period_ms SCHED_DEADLINE: the length of a period (and relative deadline), in milliseconds
+ * @return 0 on success, -1 if the parameters are invalid or the thread is not admitted
+ */
+  static size_t sched_setscheduler(size_t policy, size_t priority, size_t runtime_ms, size_t period_ms);
+
+/**
+ * waits on or wakes up a futex, a 32 bit word in userspace (see Futex)
+ *
+ * @pre IF==1
+ * @pre address < 2gb
+ * @param address the user address of the word, 4 byte aligned
+ * @param op FUTEX_WAIT: sleep if the word still holds value, until woken up by FUTEX_WAKE
+ *           FUTEX_WAKE: wake up at most value threads sleeping on the word
+ * @param value see op
+ * @return FUTEX_WAIT: 0 after being woken up, -1 if the word did not hold value
+ *         FUTEX_WAKE: the number of threads woken up
+ *         -1 if the address or op is invalid
+ */
+  static size_t futex(size_t address, size_t op, size_t value);
+
   //static size_t clone();
   //static size_t brk(..);
   //static void waitpid();
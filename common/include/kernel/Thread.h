@@ -3,6 +3,9 @@
 
 #include "types.h"
 #include "fs/FileSystemInfo.h"
+#include "RunQueue.h"
+#include "Histogram.h"
+#include "Atomic.h"
 
 #define STACK_CANARY (0xDEADDEAD)
 
@@ -21,12 +24,17 @@ class Terminal;
 class Mutex;
 class FsWorkingDirectory;
 class Lock;
+class Timer;
+class WaitQueue;
 
 extern Thread* currentThread;
 
 class Thread
 {
     friend class Scheduler;
+    friend class RunQueue;
+    friend class WaitQueue;
+    friend class RCU;
   public:
 
     static const char* threadStatePrintable[4];
@@ -115,6 +123,21 @@ class Thread
      */
     bool schedulable();
 
+    uint32 getPriority() const
+    {
+      return priority_;
+    }
+
+    int32 getNice() const
+    {
+      return nice_;
+    }
+
+    SchedulingClass getSchedulingClass() const
+    {
+      return sched_class_;
+    }
+
 
 	/**
 	 * A part of the single-chained waiters list for the locks.
@@ -136,6 +159,11 @@ class Thread
 	 */
 	Lock* holding_lock_list_;
 
+	/**
+	 * The timer which ends the timed wait on lock_waiting_on_, 0 in case the thread waits without timeout.
+	 */
+	Timer* sleep_timer_;
+
   private:
     Thread(Thread const &src);
     Thread &operator=(Thread const &src);
@@ -143,14 +171,106 @@ class Thread
     size_t num_jiffies_;
     size_t tid_;
 
+    /**
+     * priority level of the thread, 0 is the highest, see RunQueue.h
+     * it selects the run queue the thread is on, so it must not change while the thread is queued
+     */
+    uint32 priority_;
+
+    /**
+     * links of the (intrusive) pairing heap of the thread's priority level, see RunQueue.h
+     * run_queue_prev_ is the parent for the first child, the previous sibling otherwise
+     * only valid while on_run_queue_ is set, modified with interrupts disabled only
+     */
+    Thread* run_queue_child_;
+    Thread* run_queue_next_;
+    Thread* run_queue_prev_;
+    bool on_run_queue_;
+
+    /**
+     * the WaitQueue the thread is waiting on (0 if none) and the link of its (intrusive) list,
+     * modified with interrupts disabled only
+     */
+    WaitQueue* wait_queue_;
+    Thread* next_thread_in_wait_queue_;
+
+    /**
+     * the nesting level of RCU read-side critical sections and the phase the outermost one
+     * is counted in, see RCU
+     */
+    uint32 rcu_read_nesting_;
+    uint32 rcu_phase_;
+
+    /**
+     * the CPU time consumed by the thread, weighted by its nice value
+     * the run queue orders the threads of a priority level by it
+     */
+    uint64 vruntime_;
+
+    /**
+     * the nice value of the thread, NICE_MIN to NICE_MAX
+     * only change it via Scheduler::setNice()
+     */
+    int32 nice_;
+
+    /**
+     * the scheduling class of the thread and its parameters
+     * only change them via Scheduler::setScheduling()
+     */
+    SchedulingClass sched_class_;
+    uint32 rt_priority_;
+    size_t dl_runtime_ticks_;
+    size_t dl_period_ticks_;
+
+    /**
+     * deadline class: the end of the current period in ticks (the deadline)
+     * and the CPU time left in it (in units of Scheduler::runtimeClock())
+     */
+    size_t dl_deadline_;
+    int64 dl_budget_;
+
+    /**
+     * the class the thread was last queued in, a deadline thread which used up its budget
+     * is queued as normal thread until its next period starts
+     */
+    SchedulingClass run_queue_class_;
+
+    /**
+     * the priority level the thread was last queued on, its rt_priority_ or priority_
+     * or the level inherited from a thread waiting for one of its mutexes
+     */
+    uint32 run_queue_level_;
+
+    /**
+     * the rank inherited from the threads waiting for mutexes held by this thread (see RunQueue.h),
+     * NO_INHERITED_RANK if none, only changed by Scheduler::inheritPriority() and Scheduler::restorePriority()
+     */
+    uint32 inherited_rank_;
+
+    /**
+     * the position in the heap of its class (the virtual runtime, the deadline, or the enqueue order)
+     */
+    uint64 run_queue_key_;
+
+    /**
+     * scheduler statistics, see Scheduler::printSchedulingStatistics()
+     * wake_cycles_ and sleep_cycles_ are the cycle counts of the last wake() and sleepAndRelease(),
+     * 0 once they are accounted for
+     */
+    uint64 wake_cycles_;
+    uint64 sleep_cycles_;
+    uint32 context_switches_;
+    uint32 preemptions_;
+    Histogram wakeup_latency_;
+
     Terminal *my_terminal_;
 
   protected:
     FileSystemInfo* working_dir_;
 
     ustl::string name_;
-    uint64 jobs_scheduled_;
-    uint64 jobs_done_;
+    Atomic<uint64> jobs_scheduled_;
+    Atomic<uint64> jobs_done_;
 
 };
 
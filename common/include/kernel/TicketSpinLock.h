@@ -0,0 +1,83 @@
+#ifndef _TICKET_SPINLOCK_H_
+#define _TICKET_SPINLOCK_H_
+
+#include "types.h"
+#include "Atomic.h"
+
+class Thread;
+
+/**
+ * a waiter spinning with interrupts enabled yields after that many unsuccessful rounds,
+ * on a single CPU the holder can only go on if it gets the CPU
+ */
+#define SPINLOCK_YIELD_ITERATIONS 100
+
+/**
+ * @class TicketSpinLock
+ * A fair busy waiting lock for short critical sections with little contention.
+ *
+ * Every thread wanting the lock draws a ticket (next_ticket_) and spins until it is served
+ * (now_serving_), so the lock is handed over in the order it was requested. Unlike SpinLock
+ * it takes no second lock and keeps no waiters list, all waiters spin on the same counter.
+ *
+ * The lock does not depend on the scheduler, so it may be used with interrupts disabled, from
+ * interrupt handlers and before the scheduler runs. Data which is shared with interrupt handlers
+ * has to be protected with acquireIrqSave() and releaseIrqRestore() everywhere, otherwise an
+ * interrupt handler spins forever on the lock held by the thread it interrupted.
+ */
+class TicketSpinLock
+{
+  public:
+    TicketSpinLock(const char* name);
+
+    /**
+     * waits until it is the turn of the currentThread and takes the lock
+     */
+    void acquire();
+
+    /**
+     * takes the lock only if nobody holds or waits for it
+     * @return true if the lock has been acquired
+     */
+    bool acquireNonBlocking();
+
+    void release();
+
+    /**
+     * disables the interrupts and acquires the lock
+     * @return whether the interrupts were enabled before, to be passed to releaseIrqRestore()
+     */
+    bool acquireIrqSave();
+
+    /**
+     * releases the lock and enables the interrupts again if they were enabled before acquireIrqSave()
+     * @param interrupts_enabled the return value of acquireIrqSave()
+     */
+    void releaseIrqRestore(bool interrupts_enabled);
+
+    /**
+     * only meaningful if the result can not change meanwhile (e.g. with interrupts disabled on a single CPU)
+     */
+    bool isFree();
+
+    const char* getName() const
+    {
+      return name_;
+    }
+
+  private:
+    TicketSpinLock(TicketSpinLock const &);
+    TicketSpinLock &operator=(TicketSpinLock const&);
+
+    const char* name_;
+    Atomic<size_t> next_ticket_;
+    Atomic<size_t> now_serving_;
+
+    /**
+     * for detecting recursive acquisition, the thread (or the thread interrupted by an interrupt handler)
+     * which holds the lock
+     */
+    Thread* held_by_;
+};
+
+#endif
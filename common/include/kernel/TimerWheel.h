@@ -0,0 +1,143 @@
+#ifndef _TIMER_WHEEL_H_
+#define _TIMER_WHEEL_H_
+
+#include "types.h"
+#include "TicketSpinLock.h"
+
+class Thread;
+
+/**
+ * the wheel has TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots each,
+ * a slot of level n covers TIMER_WHEEL_SLOTS^n ticks
+ */
+#define TIMER_WHEEL_SLOT_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_LEVELS 4
+
+/**
+ * timeouts are cut down to this many ticks (more than 10 days with the x86 PIT)
+ */
+#define TIMER_WHEEL_MAX_TIMEOUT ((1 << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+/**
+ * @class Timer
+ * Wakes up the thread which created it in case it is still sleeping when the timer expires.
+ * Timers live on the stack of the sleeping thread, they are added to the TimerWheel by the
+ * Scheduler when the thread goes to sleep (see Scheduler::sleepFor() and Scheduler::sleepAndRelease())
+ * and have to be cancelled as soon as the thread is awake again.
+ */
+class Timer
+{
+  public:
+    /**
+     * @param timeout_ticks the number of timer ticks until the timer expires,
+     *        counted from the moment it is added to the TimerWheel
+     */
+    Timer(size_t timeout_ticks);
+
+    /**
+     * cancels the timer in case it is still pending
+     */
+    ~Timer();
+
+    /**
+     * removes the timer from the TimerWheel, does nothing if it is not pending
+     */
+    void cancel();
+
+    bool expired() const
+    {
+      return expired_;
+    }
+
+  private:
+    friend class TimerWheel;
+
+    Thread* thread_;
+    size_t timeout_ticks_;
+    size_t expires_;
+
+    /**
+     * links of the (intrusive) slot list, slot_ is 0 while the timer is not pending
+     */
+    Timer* next_;
+    Timer* prev_;
+    Timer** slot_;
+
+    bool expired_;
+};
+
+/**
+ * @class TimerWheel
+ * Hierarchical timer wheel, driven by Scheduler::incTicks().
+ * Timers which expire within the next TIMER_WHEEL_SLOTS ticks are kept in the slot of their tick in
+ * level 0, timers further away in the slots of the higher levels. Whenever level 0 wraps around, the
+ * next slot of level 1 is cascaded down (and so on), therefore adding and cancelling a timer is O(1),
+ * and every timer is moved at most TIMER_WHEEL_LEVELS - 1 times before it expires.
+ *
+ * The wheel is shared with the timer interrupt and protected by lock_, which the threads take with
+ * acquireIrqSave(). The methods take care of that themselves.
+ */
+class TimerWheel
+{
+  public:
+    static TimerWheel* instance();
+
+    /**
+     * adds the timer, it expires timeout_ticks ticks from now
+     * does nothing if the timer is already pending or expired
+     * @param timer the timer
+     * @param now the current tick count
+     */
+    void add(Timer* timer, size_t now);
+
+    /**
+     * removes the timer in case it is pending
+     * @param timer the timer
+     */
+    void cancel(Timer* timer);
+
+    /**
+     * expires all timers up to the given tick, called from the timer interrupt
+     * @param now the current tick count
+     */
+    void advance(size_t now);
+
+    bool isEmpty() const
+    {
+      return count_ == 0;
+    }
+
+  private:
+    TimerWheel();
+
+    static TimerWheel* instance_;
+
+    /**
+     * puts the timer into the slot matching its expiry tick
+     */
+    void insert(Timer* timer);
+
+    void unlink(Timer* timer);
+
+    /**
+     * moves all timers of the current slot of the given level down to the lower levels
+     * @return the index of the slot, 0 means the level wrapped around as well
+     */
+    size_t cascade(size_t level);
+
+    void expire(Timer* timer);
+
+    Timer* slots_[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+
+    /**
+     * the next tick to be processed
+     */
+    size_t current_;
+
+    size_t count_;
+
+    TicketSpinLock lock_;
+};
+
+#endif
@@ -26,6 +26,12 @@ class UserProcess : public Thread
 
     virtual ~UserProcess();
 
+    /**
+     * a thread is created for every program started, the processes are allocated from a SlabCache
+     */
+    static void* operator new(size_t size);
+    static void operator delete(void* address, size_t size);
+
     virtual void Run(); // not used
 
   private:
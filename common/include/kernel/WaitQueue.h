@@ -0,0 +1,107 @@
+#ifndef _WAIT_QUEUE_H_
+#define _WAIT_QUEUE_H_
+
+#include "types.h"
+#include "TicketSpinLock.h"
+
+class Thread;
+class Mutex;
+class Timer;
+
+/**
+ * @class WaitQueue
+ * A queue of sleeping threads waiting for an event, e.g. the completion of a block device request.
+ * A waiting thread is taken off the run queue, wakeOne() and wakeAll() put the threads back onto it,
+ * so nobody has to poll for the event.
+ *
+ * The queue is intrusive (linked through the Thread objects) and only modified while holding
+ * lock_ with interrupts disabled, therefore it can be woken up from interrupt handlers. Threads are woken up in the order
+ * they started waiting.
+ *
+ * To avoid lost wake ups the waiting thread checks the condition it waits for in a loop and either
+ * - keeps the interrupts disabled from checking the condition until calling wait(), in case the
+ *   condition is changed by an interrupt handler, or
+ * - passes the Mutex protecting the condition to wait(), it is released after the thread has been
+ *   put onto the queue (see Condition)
+ */
+class WaitQueue
+{
+  public:
+    WaitQueue(const char* name);
+
+    /**
+     * checks that no thread is waiting any longer
+     */
+    ~WaitQueue();
+
+    /**
+     * Puts the currentThread to sleep until it is woken up by wakeOne() or wakeAll().
+     * May be called with interrupts disabled, they are enabled while the thread sleeps and
+     * restored before returning.
+     * @param mutex a Mutex held by the currentThread which is released as soon as the thread
+     *        is on the queue, 0 if none. It is not re-acquired after waking up.
+     */
+    void wait(Mutex* mutex = 0);
+
+    /**
+     * Like wait, but the thread wakes up after the given number of timer ticks at the latest.
+     * @param timeout_ticks the maximum number of ticks to wait
+     * @param mutex see wait()
+     * @return true if woken up by wakeOne() or wakeAll(), false if the timeout expired
+     */
+    bool waitWithTimeout(size_t timeout_ticks, Mutex* mutex = 0);
+
+    /**
+     * wakes up the thread waiting the longest, may be called from interrupt handlers
+     * @return true if a thread was waiting
+     */
+    bool wakeOne();
+
+    /**
+     * wakes up all waiting threads, may be called from interrupt handlers
+     * the whole list is detached at once, threads starting to wait meanwhile wait for the next wake up
+     * @return the number of threads woken up
+     */
+    size_t wakeAll();
+
+    bool isEmpty() const
+    {
+      return head_ == 0;
+    }
+
+    const char* getName() const
+    {
+      return name_;
+    }
+
+  private:
+    WaitQueue(WaitQueue const &src);
+    WaitQueue &operator=(WaitQueue const &src);
+
+    /**
+     * the implementation of wait and waitWithTimeout
+     * @param timeout the timer ending the wait, 0 to wait until woken up
+     * @return false if the timeout expired
+     */
+    bool doWait(Timer* timeout, Mutex* mutex);
+
+    /**
+     * the following methods have to be called holding lock_ with interrupts disabled
+     */
+    void append(Thread* thread);
+    Thread* popFront();
+    void remove(Thread* thread);
+    void wake(Thread* thread);
+
+    const char* name_;
+
+    TicketSpinLock lock_;
+
+    /**
+     * the single chained list of waiting threads, linked by Thread::next_thread_in_wait_queue_
+     */
+    Thread* head_;
+    Thread* tail_;
+};
+
+#endif
@@ -53,10 +53,30 @@
 #define sc_flock 143
 #define sc_msync 144
 //....
+#define sc_sched_setscheduler 156
+//....
 #define sc_sched_yield 158
 //....
+#define sc_nanosleep 162
+//....
 #define sc_vfork 190
 #define sc_createprocess 191
+//....
+#define sc_futex 240
 
 #define sc_trace 252
 
+/**
+ * scheduling policies of sc_sched_setscheduler
+ */
+#define SCHED_OTHER 0
+#define SCHED_FIFO 1
+#define SCHED_RR 2
+#define SCHED_DEADLINE 6
+
+/**
+ * operations of sc_futex
+ */
+#define FUTEX_WAIT 0
+#define FUTEX_WAKE 1
+
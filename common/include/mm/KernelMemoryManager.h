@@ -73,6 +73,20 @@ class MallocSegment
         size_flag_ |= 0x80000000; //this is the used flag
     }
 
+    /**
+     * the neighbours in the free list of the segment, kept at the start of its memory,
+     * only valid while the segment is free and at least KMM_MIN_FREE_SIZE bytes large
+     */
+    MallocSegment*& nextFree()
+    {
+      return ((MallocSegment**) (this + 1))[0];
+    }
+
+    MallocSegment*& previousFree()
+    {
+      return ((MallocSegment**) (this + 1))[1];
+    }
+
     uint32 marker_; // = 0xdeadbeef;
     MallocSegment *next_; // = NULL;
     MallocSegment *prev_; // = NULL;
@@ -83,6 +97,20 @@ class MallocSegment
 
 extern void* kernel_end_address;
 
+/**
+ * the free segments are kept in lists by size: the first level is the power of two at or below the size,
+ * the second level splits this range into KMM_SECOND_LEVELS equal parts
+ */
+#define KMM_FIRST_LEVELS 32
+#define KMM_SECOND_LEVEL_BITS 2
+#define KMM_SECOND_LEVELS (1 << KMM_SECOND_LEVEL_BITS)
+
+/**
+ * the smallest segment kept in a free list, it has to hold the two list pointers,
+ * allocations are rounded up to it
+ */
+#define KMM_MIN_FREE_SIZE 0x10
+
 class KernelMemoryManager
 {
   public:
@@ -118,6 +146,12 @@ class KernelMemoryManager
 
     Mutex& getKMMLock();
 
+    /**
+     * fragments the heap with small allocations and measures the cycles an allocation or free takes,
+     * the heap is as before afterwards
+     */
+    void benchmark();
+
     Thread* KMMLockHeldBy();
 
     KernelMemoryManager() : lock_(0) { assert(false && "dummy constructor - do not use!"); };
@@ -134,12 +168,33 @@ class KernelMemoryManager
   private:
 
     /**
-     * returns a free memory segment of the requested size
+     * returns a free memory segment of the requested size, removed from its free list
      * @param requested_size the size
      * @return the segment
      */
     MallocSegment *findFreeSegment(size_t requested_size);
 
+    /**
+     * the free list of segments of the given size
+     */
+    static void getFreeList(size_t size, size_t& first_level, size_t& second_level);
+
+    /**
+     * adds a free segment to its free list, segments smaller than KMM_MIN_FREE_SIZE are not kept in one
+     */
+    void insertFreeSegment(MallocSegment *segment);
+
+    /**
+     * removes a free segment from its free list and clears the list pointers,
+     * has to be done before it is used or its size changes
+     */
+    void removeFreeSegment(MallocSegment *segment);
+
+    /**
+     * walks all segments and checks their markers, only done with KMM debugging enabled
+     */
+    void checkSegments();
+
     /**
      * creates a new segment after the given one if the space is big enough
      * @param this_one the segment
@@ -185,6 +240,13 @@ class KernelMemoryManager
 
     Mutex lock_;
 
+    /**
+     * the free lists, a bit is set in the bitmaps for every list which is not empty
+     */
+    MallocSegment* free_lists_[KMM_FIRST_LEVELS][KMM_SECOND_LEVELS];
+    uint32 first_level_bitmap_;
+    uint32 second_level_bitmaps_[KMM_FIRST_LEVELS];
+
     uint32 segments_used_;
     uint32 segments_free_;
     size_t approx_memory_free_;
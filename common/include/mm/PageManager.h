@@ -6,6 +6,16 @@
 #include "Mutex.h"
 #include "Bitmap.h"
 
+// the largest block of the buddy allocator has 2^PM_MAX_ORDER pages
+#define PM_MAX_ORDER 10
+
+/**
+ * @class PageManager
+ * Hands out the physical pages with a buddy allocator: the free pages are kept as blocks of 2^order pages,
+ * aligned to their size, in one free list per order. An allocation splits the smallest block which is big
+ * enough, freeing merges a block with its buddy as long as the buddy is free as well. The bitmap still
+ * tells for every page whether it is used.
+ */
 class PageManager
 {
   public:
@@ -19,19 +29,41 @@ class PageManager
     uint32 getTotalNumPages() const;
 
     /**
-     * returns the number of the lowest free Page
+     * returns the number of a free Page
      * and marks that Page as used.
      * returns always 4kb ppns!
+     * @param page_size a power of two multiple of PAGE_SIZE, up to 2^PM_MAX_ORDER pages,
+     *        the pages are contiguous and aligned to page_size
      */
     uint32 allocPPN(uint32 page_size = PAGE_SIZE);
 
+    /**
+     * like allocPPN, but for callers which can do without the pages
+     * @return 0 if there is no free block of page_size
+     */
+    uint32 tryAllocPPN(uint32 page_size);
+
+    /**
+     * allocates single pages, they do not have to be contiguous
+     * @param ppns receives the page numbers
+     * @param num the number of pages
+     * @return the number of pages allocated, less than num only if the memory is exhausted
+     */
+    size_t allocPPNs(uint32* ppns, size_t num);
+
     /**
      * marks physical page <page_number> as free, if it was used in
      * user or kernel space.
+     * The pages of a bigger allocation may also be freed one by one.
      * @param page_number Physcial Page to mark as unused
      */
     void freePPN(uint32 page_number, uint32 page_size = PAGE_SIZE);
 
+    /**
+     * @return the number of 4k pages which are free at the moment
+     */
+    uint32 getNumFreePages();
+
     Thread* heldBy()
     {
       return lock_.heldBy();
@@ -39,25 +71,47 @@ class PageManager
 
     PageManager();
 
-    void printBitmap()
-    {
-      page_usage_table_->bmprint();
-    }
+    /**
+     * prints the bitmap and the number of free blocks of each order
+     */
+    void printBitmap();
 
   private:
     /**
-     * used internally to mark pages as reserved
-     * @param ppn
-     * @param num
-     * @return
+     * takes a block of 2^order pages from the free lists and marks its pages as used
+     * @return the first page of the block, 0 if there is none
+     */
+    uint32 allocBlock(uint32 order);
+
+    /**
+     * puts a block of 2^order free pages back, merged with its buddies
+     */
+    void freeBlock(uint32 ppn, uint32 order);
+
+    /**
+     * puts the pages [ppn, ppn + num) back as the biggest aligned blocks they consist of
      */
-    bool reservePages(uint32 ppn, uint32 num = 1);
+    void freeRange(uint32 ppn, uint32 num);
+
+    void insertFreeBlock(uint32 ppn, uint32 order);
+    void removeFreeBlock(uint32 ppn);
 
     PageManager(PageManager const&);
 
     Bitmap* page_usage_table_;
     uint32 number_of_pages_;
-    uint32 lowest_unreserved_page_;
+
+    /**
+     * the first page of the free blocks of each order, the blocks are linked through
+     * next_free_block_ and previous_free_block_ of their first page
+     */
+    uint32 free_lists_[PM_MAX_ORDER + 1];
+    uint32* next_free_block_;
+    uint32* previous_free_block_;
+    /**
+     * the order of the free block starting at a page, PM_NO_BLOCK for all other pages
+     */
+    uint8* free_block_order_;
 
     Mutex lock_;
 
@@ -0,0 +1,146 @@
+#ifndef SLABALLOCATOR_H__
+#define SLABALLOCATOR_H__
+
+#include "types.h"
+#include "Mutex.h"
+#include "Atomic.h"
+
+/**
+ * @class SlabCache
+ * An object cache for kernel objects of one type, all of the same size.
+ *
+ * The objects live in slabs, a few physically contiguous pages from the PageManager reached through the
+ * identity mapping. Each slab starts with its header and keeps a free list of its objects, so allocating
+ * and freeing does not search anything: a slab is found by masking the object address, the object is
+ * taken from (or put back to) the front of its free list. A freed object is handed out again first
+ * while it is still in the cache, and a few empty slabs are kept instead of going back to the
+ * PageManager, so a type which is created and destroyed all the time does not touch the PageManager.
+ * Each cache has a lock of its own, unlike the heap of the KernelMemoryManager.
+ *
+ * The type routes its objects here with a class-level operator new and operator delete(void*, size_t),
+ * see SlabAllocator::getCache(). Derived classes which are bigger than the cached type inherit these
+ * operators, their objects are passed on to the global operator new.
+ */
+class SlabCache
+{
+  public:
+    SlabCache(const char* name, size_t object_size);
+
+    /**
+     * @param size the size of the object, as passed to operator new
+     * @return a zeroed object
+     */
+    void* allocate(size_t size);
+
+    /**
+     * @param object an object returned by allocate
+     * @param size the size passed to allocate, as passed to operator delete
+     */
+    void free(void* object, size_t size);
+
+    const char* getName() const
+    {
+      return name_;
+    }
+
+    size_t getObjectSize() const
+    {
+      return object_size_;
+    }
+
+    void printStatistics();
+
+  private:
+    SlabCache(SlabCache const&);
+    SlabCache &operator=(SlabCache const&);
+
+    friend class SlabAllocator;
+
+    /**
+     * the header at the start of every slab, the objects follow it
+     */
+    struct Slab
+    {
+        Slab* next_;
+        Slab* prev_;
+        void* free_list_;
+        size_t objects_in_use_;
+        size_t ppn_;
+    };
+
+    Slab* createSlab();
+    void destroySlab(Slab* slab);
+
+    static void pushFront(Slab*& list, Slab* slab);
+    static void unlink(Slab*& list, Slab* slab);
+
+    const char* name_;
+    size_t object_size_;
+    size_t slab_pages_;
+    size_t objects_per_slab_;
+
+    /**
+     * the slabs with free and used objects, without free objects and without used objects
+     */
+    Slab* partial_;
+    Slab* full_;
+    Slab* empty_;
+    size_t empty_slabs_;
+
+    Mutex lock_;
+
+    size_t slabs_;
+    size_t objects_in_use_;
+    size_t peak_objects_in_use_;
+    size_t allocations_;
+    Atomic<size_t> fallback_allocations_;
+
+    SlabCache* next_cache_;
+};
+
+/**
+ * @class SlabAllocator
+ * Creates the SlabCaches and keeps the list of them for the statistics.
+ * A type uses a cache of its own like this:
+ *
+ *   static SlabCache* dentry_cache;
+ *   void* Dentry::operator new(size_t size)
+ *   {
+ *     return SlabAllocator::instance()->getCache(dentry_cache, "Dentry", sizeof(Dentry))->allocate(size);
+ *   }
+ */
+class SlabAllocator
+{
+  public:
+    static SlabAllocator* instance();
+
+    /**
+     * @param cache where the cache is kept, it is created on the first call
+     * @param name the name of the cached type, for the statistics
+     * @param object_size the size of the cached type
+     * @return the cache
+     */
+    SlabCache* getCache(SlabCache*& cache, const char* name, size_t object_size)
+    {
+      if (likely(cache != 0))
+        return cache;
+      return createCache(cache, name, object_size);
+    }
+
+    /**
+     * prints the usage of every cache, to see whether the slab sizes fit
+     */
+    void printStatistics();
+
+  private:
+    SlabAllocator();
+
+    SlabCache* createCache(SlabCache*& cache, const char* name, size_t object_size);
+
+    Mutex lock_;
+    SlabCache* caches_;
+
+    static SlabAllocator* instance_;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef ATOMIC_H__
+#define ATOMIC_H__
+
+#include "types.h"
+
+/**
+ * the ordering an atomic operation imposes on the surrounding memory accesses
+ * RELAXED: only the operation itself is atomic
+ * ACQUIRE: later accesses cannot move before it (taking a lock, reading a published index)
+ * RELEASE: earlier accesses cannot move after it (releasing a lock, publishing an index)
+ * ACQ_REL: both, for read-modify-write operations
+ * SEQ_CST: additionally a single total order of all SEQ_CST operations (a full barrier)
+ */
+enum MemoryOrder
+{
+  MEMORY_ORDER_RELAXED, MEMORY_ORDER_ACQUIRE, MEMORY_ORDER_RELEASE, MEMORY_ORDER_ACQ_REL, MEMORY_ORDER_SEQ_CST
+};
+
+// the architecture specific operations on a plain T, see ArchAtomic.h of the architecture
+#include "ArchAtomic.h"
+
+/**
+ * @class Atomic
+ * A variable of an integral or pointer type T which is only accessed by atomic operations.
+ * The memory order of each operation can be given explicitly, the default is the full barrier
+ * the ArchThreads functions always pay. Locks usually only need ACQUIRE when taking them
+ * and RELEASE when releasing them.
+ * The constructor is constexpr, so global and static Atomics are initialised without a constructor call.
+ */
+template<typename T>
+class Atomic
+{
+  public:
+    constexpr Atomic(T value = T()) :
+        value_(value)
+    {
+    }
+
+    T load(MemoryOrder order = MEMORY_ORDER_SEQ_CST) const
+    {
+      return ArchAtomic::load(value_, order);
+    }
+
+    void store(T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+    {
+      ArchAtomic::store(value_, value, order);
+    }
+
+    /**
+     * @return the previous value
+     */
+    T exchange(T value, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+    {
+      return ArchAtomic::exchange(value_, value, order);
+    }
+
+    /**
+     * replaces the value with desired if it equals expected
+     * @param expected receives the current value in case it differs
+     * @return true if the value has been replaced
+     */
+    bool compareExchange(T& expected, T desired, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+    {
+      return ArchAtomic::compareExchange(value_, expected, desired, order);
+    }
+
+    /**
+     * @return the previous value
+     */
+    T fetchAdd(T increment, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+    {
+      return ArchAtomic::fetchAdd(value_, increment, order);
+    }
+
+    /**
+     * @return the previous value
+     */
+    T fetchSub(T decrement, MemoryOrder order = MEMORY_ORDER_SEQ_CST)
+    {
+      return ArchAtomic::fetchAdd(value_, (T) (0 - decrement), order);
+    }
+
+  private:
+    Atomic(Atomic const&);
+    Atomic &operator=(Atomic const&);
+
+    T value_;
+};
+
+#endif
@@ -5,10 +5,23 @@
 
 uint8 const bits_per_bitmap_atom_ = 8;
 
+// 64^6 bits cover any size_t of a 32 bit kernel
+#define BITMAP_MAX_LEVELS 6
+#define BITMAP_WORD_BITS 64
+
+/**
+ * @class Bitmap
+ * The bits are kept in 64 bit words. Above them are two summaries with one bit per word of the level below:
+ * one tells whether the word is full, the other whether it has any bit set. With a summary level for every
+ * 64 words of the level below, finding the next unset or set bit takes one word per level, and a run of
+ * unset bits is found by jumping from one run to the next instead of testing bit by bit.
+ */
 class Bitmap
 {
 
 public:
+  static const size_t NOT_FOUND = (size_t) -1;
+
   Bitmap (size_t number_of_bits);
   ~Bitmap ();
   void setBit(size_t bit_number);
@@ -16,6 +29,35 @@ public:
   void unsetBit(size_t bit_number);
   size_t getSize() { return size_; }
 
+  /**
+   * sets the bits [bit_number, bit_number + num)
+   */
+  void setRange(size_t bit_number, size_t num);
+
+  /**
+   * unsets the bits [bit_number, bit_number + num)
+   */
+  void clearRange(size_t bit_number, size_t num);
+
+  /**
+   * @param from the first bit to look at
+   * @return the lowest unset bit from on, NOT_FOUND if there is none
+   */
+  size_t findFirstZero(size_t from = 0);
+
+  /**
+   * @param from the first bit to look at
+   * @return the lowest set bit from on, NOT_FOUND if there is none
+   */
+  size_t findFirstOne(size_t from = 0);
+
+  /**
+   * @param num the number of unset bits in a row
+   * @param from the first bit to look at
+   * @return the first bit of the lowest run of num unset bits from on, NOT_FOUND if there is none
+   */
+  size_t findZeroRun(size_t num, size_t from = 0);
+
   /**
    * returns the number of bits set
    * @return the number of bits set
@@ -50,9 +92,32 @@ public:
   uint8 getByte(size_t byte_number);
 
 private:
+  Bitmap(Bitmap const&);
+  Bitmap &operator=(Bitmap const&);
+
+  /**
+   * replaces a word of the bits and updates the count and the summaries
+   */
+  void changeWord(size_t word_number, uint64 value);
+
+  /**
+   * sets or unsets the bit of a word of the level below in a summary, and in the levels above as far as needed
+   * @param full whether the summary of the full words is changed, otherwise the one of the non-empty words
+   */
+  void updateSummary(bool full, size_t word_number, bool set);
+
+  size_t find(bool zero, size_t level, size_t from);
+
   size_t size_;
   size_t num_bits_set_;
-  uint8 *bitmap_;
+
+  size_t num_levels_;
+  size_t level_words_[BITMAP_MAX_LEVELS];
+  /**
+   * level 0 of both are the bits themselves, the bits past size_ are set
+   */
+  uint64* full_[BITMAP_MAX_LEVELS];
+  uint64* non_empty_[BITMAP_MAX_LEVELS];
 };
 
 #endif /* BITMAP_H__ */
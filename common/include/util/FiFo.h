@@ -96,6 +96,7 @@ FiFo<T>::~FiFo()
 
 //only put uses the fallback buffer -> so it doesn't need a lock
 //input_buffer could be in use -> so if locked use fallback
+//readers only wait while the buffer is empty, so only the first element wakes them up (all of them)
 template<class T>
 void FiFo<T>::put(T c)
 {
@@ -116,7 +117,8 @@ void FiFo<T>::put(T c)
       while (ib_write_pos_ == ib_read_pos_)
         space_to_write_.wait();
   }
-  something_to_read_.signal();
+  if (ib_write_pos_ == ((ib_read_pos_ + 1) % input_buffer_size_))
+    something_to_read_.broadcast();
   input_buffer_[ib_write_pos_++] = c;
   ib_write_pos_ %= input_buffer_size_;
   input_buffer_lock_.release();
@@ -132,6 +134,7 @@ void FiFo<T>::clear(void)
 }
 
 //now this routine could get preempted
+//writers only wait while the buffer is full, so only the first free slot wakes them up (all of them)
 template<class T>
 T FiFo<T>::get()
 {
@@ -141,7 +144,8 @@ T FiFo<T>::get()
   while (ib_write_pos_ == ((ib_read_pos_ + 1) % input_buffer_size_)) //nothing new to read
     something_to_read_.wait(); //this implicates release & acquire
 
-  space_to_write_.signal();
+  if (ib_write_pos_ == ib_read_pos_)
+    space_to_write_.broadcast();
   ib_read_pos_ = (ib_read_pos_ + 1) % input_buffer_size_;
   ret = input_buffer_[ib_read_pos_];
 
@@ -0,0 +1,51 @@
+#ifndef HISTOGRAM_H__
+#define HISTOGRAM_H__
+
+#include "types.h"
+
+#define HISTOGRAM_BUCKETS 32
+
+/**
+ * @class Histogram
+ * Counts values in power of two buckets: bucket 0 holds the value 0, bucket n the values
+ * from 2^(n-1) to 2^n - 1, the last bucket everything above.
+ * Adding a value is a bit scan and a few additions, cheap enough for the scheduler's hot paths.
+ * No locking is done, the caller has to ensure that it is not modified concurrently.
+ */
+class Histogram
+{
+  public:
+    Histogram();
+
+    void add(uint64 value);
+
+    uint64 getCount() const
+    {
+      return count_;
+    }
+
+    uint64 getMax() const
+    {
+      return max_;
+    }
+
+    uint64 getAverage() const
+    {
+      return count_ ? sum_ / count_ : 0;
+    }
+
+    /**
+     * prints the non-empty buckets using kprintfd
+     * @param name what is counted
+     * @param unit the unit of the values
+     */
+    void print(const char* name, const char* unit) const;
+
+  private:
+    uint32 buckets_[HISTOGRAM_BUCKETS];
+    uint64 count_;
+    uint64 sum_;
+    uint64 max_;
+};
+
+#endif
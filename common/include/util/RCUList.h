@@ -0,0 +1,178 @@
+#ifndef _RCU_LIST_H_
+#define _RCU_LIST_H_
+
+#include "types.h"
+#ifndef EXE2MINIXFS
+#include "RCU.h"
+#else
+struct RCUHead
+{
+};
+#endif
+
+/**
+ * @class RCUList
+ * A singly linked list readers walk without taking a lock, inside a read-side critical section (see RCU).
+ * Writers only change a single next pointer readers might follow: an element is appended by linking in
+ * a completely initialized node, and removed by linking its predecessor past it. The removed node keeps
+ * its next pointer, so readers standing on it can go on, and it is freed after a grace period.
+ * Writers have to be serialized by the user of the list.
+ * T has to be a plain type, e.g. a pointer.
+ * A zero initialized RCUList is a valid empty list, so it may be used before the global constructors ran.
+ */
+template<typename T>
+class RCUList
+{
+  private:
+    struct Node
+    {
+        RCUHead rcu_head_;
+        T element_;
+        Node* next_;
+    };
+
+    static Node* next(Node* const& node)
+    {
+      return *(Node* const volatile*) &node;
+    }
+
+  public:
+    class Iterator
+    {
+      public:
+        Iterator(Node* node) :
+            node_(node)
+        {
+        }
+
+        const T& operator*() const
+        {
+          return node_->element_;
+        }
+
+        Iterator& operator++()
+        {
+          node_ = next(node_->next_);
+          return *this;
+        }
+
+        bool operator!=(const Iterator& other) const
+        {
+          return node_ != other.node_;
+        }
+
+      private:
+        Node* node_;
+    };
+
+    /**
+     * the elements of the list, valid until the reader leaves its read-side critical section
+     * elements appended or removed meanwhile may or may not be seen
+     */
+    class Range
+    {
+      public:
+        Range(Node* first) :
+            first_(first)
+        {
+        }
+
+        Iterator begin() const
+        {
+          return Iterator(first_);
+        }
+
+        Iterator end() const
+        {
+          return Iterator(0);
+        }
+
+      private:
+        Node* first_;
+    };
+
+    RCUList() :
+        head_(0), tail_(0), size_(0)
+    {
+    }
+
+    /**
+     * @return the elements, has to be called inside a read-side critical section
+     *         or holding the lock of the writers
+     */
+    Range read() const
+    {
+      return Range(next(head_));
+    }
+
+    size_t size() const
+    {
+      return *(const volatile size_t*) &size_;
+    }
+
+    /**
+     * appends the element
+     */
+    void pushBack(const T& element)
+    {
+      Node* node = new Node;
+      node->element_ = element;
+      node->next_ = 0;
+      // the node has to be complete before readers can find it
+      asm volatile("" : : : "memory");
+      *(Node* volatile*) (tail_ ? &tail_->next_ : &head_) = node;
+      tail_ = node;
+      ++size_;
+    }
+
+    /**
+     * removes the elements equal to the given one, if there are any
+     */
+    void remove(const T& element)
+    {
+      Node* previous = 0;
+      Node* node = head_;
+      while (node)
+      {
+        Node* following = node->next_;
+        if (node->element_ == element)
+        {
+          *(Node* volatile*) (previous ? &previous->next_ : &head_) = following;
+          if (tail_ == node)
+            tail_ = previous;
+          --size_;
+          reclaimLater(node);
+        }
+        else
+          previous = node;
+        node = following;
+      }
+    }
+
+  private:
+    RCUList(RCUList const&);
+    RCUList &operator=(RCUList const&);
+
+    static void reclaimLater(Node* node)
+    {
+#ifndef EXE2MINIXFS
+      RCU::instance()->call(&node->rcu_head_, &reclaim);
+#else
+      delete node;
+#endif
+    }
+
+    static void reclaim(RCUHead* head)
+    {
+      delete (Node*) head;
+    }
+
+    Node* head_;
+    /**
+     * only used by the writers
+     */
+    Node* tail_;
+    size_t size_;
+};
+
+#endif
@@ -14,7 +14,7 @@ extern "C"
 #endif
 
 #include "new.h"
-#include "ArchThreads.h"
+#include "Atomic.h"
 #include "assert.h"
 
 /**
@@ -25,6 +25,8 @@ extern "C"
  * any synchronization or mutual exclusion primitives. For this to work correctly,
  * there can only be a single reader and a single writer thread. Their identities
  * cannot be interchanged.
+ * Each side publishes its position with a release store once it is done with the element and
+ * reads the position of the other side with an acquire load before touching an element.
  */
 template<class T>
 class RingBuffer
@@ -66,8 +68,8 @@ class RingBuffer
 
     size_t buffer_size_;
     T *buffer_;
-    size_t write_pos_;
-    size_t read_pos_;
+    Atomic<size_t> write_pos_;
+    Atomic<size_t> read_pos_;
 };
 
 template <class T>
@@ -76,8 +78,8 @@ RingBuffer<T>::RingBuffer ( uint32 size )
   assert ( size>1 );
   buffer_size_=size;
   buffer_=new T[buffer_size_];
-  write_pos_=1;
-  read_pos_=0;
+  write_pos_.store ( 1, MEMORY_ORDER_RELAXED );
+  read_pos_.store ( 0, MEMORY_ORDER_RELAXED );
 }
 
 template <class T>
@@ -89,30 +91,30 @@ RingBuffer<T>::~RingBuffer()
 template <class T>
 void RingBuffer<T>::put ( T c )
 {
-  size_t old_write_pos=write_pos_;
-  if ( old_write_pos == read_pos_ )
+  size_t old_write_pos=write_pos_.load ( MEMORY_ORDER_RELAXED );
+  if ( old_write_pos == read_pos_.load ( MEMORY_ORDER_ACQUIRE ) )
     return;
   buffer_[old_write_pos]=c;
-  ArchThreads::testSetLock ( write_pos_, ( old_write_pos + 1 ) % buffer_size_ );
+  write_pos_.store ( ( old_write_pos + 1 ) % buffer_size_, MEMORY_ORDER_RELEASE );
 }
 
 template <class T>
 void RingBuffer<T>::clear()
 {
-  ArchThreads::testSetLock ( write_pos_,1 );
+  write_pos_.store ( 1, MEMORY_ORDER_SEQ_CST );
   // assumed that there is only one reader who can't have called clear and get at the same time.
   // here get would return garbage.
-  ArchThreads::testSetLock ( read_pos_,0 );
+  read_pos_.store ( 0, MEMORY_ORDER_SEQ_CST );
 }
 
 template <class T>
 bool RingBuffer<T>::get ( T &c )
 {
-  uint32 new_read_pos = ( read_pos_ + 1 ) % buffer_size_;
-  if ( write_pos_ == new_read_pos ) //nothing new to read
+  uint32 new_read_pos = ( read_pos_.load ( MEMORY_ORDER_RELAXED ) + 1 ) % buffer_size_;
+  if ( write_pos_.load ( MEMORY_ORDER_ACQUIRE ) == new_read_pos ) //nothing new to read
     return false;
   c = buffer_[new_read_pos];
-  ArchThreads::testSetLock ( read_pos_,new_read_pos );
+  read_pos_.store ( new_read_pos, MEMORY_ORDER_RELEASE );
   return true;
 }
 
@@ -3,6 +3,8 @@
 #include "KeyboardManager.h"
 #include "Scheduler.h"
 #include "PageManager.h"
+#include "SlabAllocator.h"
+#include "KernelMemoryManager.h"
 
 Console* main_console;
 
@@ -41,6 +43,18 @@ void Console::handleKey(uint32 key)
 // else...
   switch (key)
   {
+    case KEY_F5:
+      KernelMemoryManager::instance()->benchmark();
+      break;
+
+    case KEY_F6:
+      SlabAllocator::instance()->printStatistics();
+      break;
+
+    case KEY_F7:
+      Scheduler::instance()->printSchedulingStatistics();
+      break;
+
     case KEY_F8:
       PageManager::instance()->printBitmap();
       break;
@@ -65,6 +65,7 @@ void kprintf_init()
   nosleep_rb_ = new RingBuffer<char>(1024);
   debug(KPRINTF, "Adding Important kprintf Flush Thread\n");
   flush_thread_ = new KprintfFlushingThread();
+  Scheduler::instance()->setScheduling(flush_thread_, SCHED_CLASS_RT, KERNEL_RT_PRIORITY);
   Scheduler::instance()->addNewThread(flush_thread_);
 }
 
@@ -3,6 +3,23 @@
 #include "Inode.h"
 
 #include "kprintf.h"
+#ifndef EXE2MINIXFS
+#include "SlabAllocator.h"
+#endif
+
+#ifndef EXE2MINIXFS
+static SlabCache* dentry_cache;
+
+void* Dentry::operator new(size_t size)
+{
+  return SlabAllocator::instance()->getCache(dentry_cache, "Dentry", sizeof(Dentry))->allocate(size);
+}
+
+void Dentry::operator delete(void* address, size_t size)
+{
+  dentry_cache->free(address, size);
+}
+#endif
 
 Dentry::Dentry(const char* name) :
     d_inode_(0), d_parent_(this), d_mounts_(0), d_name_(name)
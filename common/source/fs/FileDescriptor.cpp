@@ -1,20 +1,35 @@
 #include "FileDescriptor.h"
-#include <ulist.h>
 #ifndef EXE2MINIXFS
-#include "ArchThreads.h"
 #include "Mutex.h"
+#include "RCU.h"
+#include "SlabAllocator.h"
 #endif
 #include "kprintf.h"
+#include "Atomic.h"
 
-ustl::list<FileDescriptor*> global_fd;
+RCUList<FileDescriptor*> global_fd;
 Mutex global_fd_lock("global_fd_lock");
 
-static size_t fd_num_ = 3;
+static Atomic<size_t> fd_num_(3);
+
+#ifndef EXE2MINIXFS
+static SlabCache* fd_cache;
+
+void* FileDescriptor::operator new(size_t size)
+{
+  return SlabAllocator::instance()->getCache(fd_cache, "FileDescriptor", sizeof(FileDescriptor))->allocate(size);
+}
+
+void FileDescriptor::operator delete(void* address, size_t size)
+{
+  fd_cache->free(address, size);
+}
+#endif
 
 void FileDescriptor::add(FileDescriptor* fd)
 {
   MutexLock ml(global_fd_lock);
-  global_fd.push_back(fd);
+  global_fd.pushBack(fd);
 }
 
 void FileDescriptor::remove(FileDescriptor* fd)
@@ -23,8 +38,17 @@ void FileDescriptor::remove(FileDescriptor* fd)
   global_fd.remove(fd);
 }
 
+void FileDescriptor::destroy(FileDescriptor* fd)
+{
+#ifndef EXE2MINIXFS
+  RCU::instance()->deferDelete(fd);
+#else
+  delete fd;
+#endif
+}
+
 FileDescriptor::FileDescriptor(File* file)
 {
-  fd_ = ArchThreads::atomic_add(fd_num_, 1);
+  fd_ = fd_num_.fetchAdd(1, MEMORY_ORDER_RELAXED);
   file_ = file;
 }
@@ -9,6 +9,7 @@
 #include "FileSystemInfo.h"
 #ifndef EXE2MINIXFS
 #include "Mutex.h"
+#include "RWLock.h"
 #include "Thread.h"
 #endif
 
@@ -19,6 +20,8 @@
 
 extern FileSystemInfo* default_working_dir;
 
+RWLock vfs_lock("vfs_lock");
+
 int32 PathWalker::pathWalk(const char* pathname, uint32 flags_ __attribute__ ((unused)), Dentry*& dentry_,
                            VfsMount*& vfs_mount_)
 {
@@ -16,6 +16,8 @@
 #include "kprintf.h"
 #ifndef EXE2MINIXFS
 #include "Mutex.h"
+#include "RWLock.h"
+#include "RCU.h"
 #include "Thread.h"
 #endif
 
@@ -23,12 +25,18 @@
 #define CHAR_DOT '.'
 
 extern FileSystemInfo* default_working_dir;
+extern RWLock vfs_lock;
+
+/**
+ * opening files under the read locked vfs_lock runs in parallel,
+ * this protects the lists of open files of the superblocks
+ */
+Mutex open_files_lock("open_files_lock");
 
 FileDescriptor* VfsSyscall::getFileDescriptor(uint32 fd)
 {
-  extern Mutex global_fd_lock;
-  MutexLock mlock(global_fd_lock);
-  for (auto it : global_fd)
+  RCUReadLock rl;
+  for (FileDescriptor* it : global_fd.read())
   {
     if (it->getFd() == fd)
     {
@@ -64,6 +72,7 @@ int32 VfsSyscall::mkdir(const char* pathname, int32)
 {
   debug(VFSSYSCALL, "(mkdir) \n");
   FileSystemInfo *fs_info = currentThread ? currentThread->getWorkingDirInfo() : default_working_dir;
+  ScopedWriteLock wl(vfs_lock);
   Dentry* pw_dentry = 0;
   VfsMount* pw_vfs_mount = 0;
   if (dupChecking(pathname, pw_dentry, pw_vfs_mount) == 0)
@@ -112,6 +121,7 @@ int32 VfsSyscall::mkdir(const char* pathname, int32)
 Dirent* VfsSyscall::readdir(const char* pathname)
 {
   FileSystemInfo *fs_info = currentThread ? currentThread->getWorkingDirInfo() : default_working_dir;
+  ScopedReadLock rl(vfs_lock);
   Dentry* pw_dentry = 0;
   VfsMount* pw_vfs_mount = 0;
   if (dupChecking(pathname, pw_dentry, pw_vfs_mount) == 0)
@@ -163,6 +173,7 @@ Dirent* VfsSyscall::readdir(const char* pathname)
 int32 VfsSyscall::chdir(const char* pathname)
 {
   FileSystemInfo *fs_info = currentThread ? currentThread->getWorkingDirInfo() : default_working_dir;
+  ScopedReadLock rl(vfs_lock);
   Dentry* pw_dentry = 0;
   VfsMount* pw_vfs_mount = 0;
   if (dupChecking(pathname, pw_dentry, pw_vfs_mount) != 0)
@@ -186,6 +197,7 @@ int32 VfsSyscall::chdir(const char* pathname)
 int32 VfsSyscall::rm(const char* pathname)
 {
   debug(VFSSYSCALL, "(rm) name: %s\n", pathname);
+  ScopedWriteLock wl(vfs_lock);
   Dentry* pw_dentry = 0;
   VfsMount* pw_vfs_mount = 0;
   if (dupChecking(pathname, pw_dentry, pw_vfs_mount) != 0)
@@ -221,6 +233,7 @@ int32 VfsSyscall::rm(const char* pathname)
 
 int32 VfsSyscall::rmdir(const char* pathname)
 {
+  ScopedWriteLock wl(vfs_lock);
   Dentry* pw_dentry = 0;
   VfsMount* pw_vfs_mount = 0;
   if (dupChecking(pathname, pw_dentry, pw_vfs_mount) != 0)
@@ -267,6 +280,7 @@ int32 VfsSyscall::close(uint32 fd)
     return -1;
   }
   Inode* current_inode = file_descriptor->getFile()->getInode();
+  MutexLock ml(open_files_lock);
   assert(current_inode->getSuperblock()->removeFd(current_inode, file_descriptor) == 0);
   return 0;
 }
@@ -281,71 +295,83 @@ int32 VfsSyscall::open(const char* pathname, uint32 flag)
   }
   Dentry* pw_dentry = 0;
   VfsMount* pw_vfs_mount = 0;
-  if (dupChecking(pathname, pw_dentry, pw_vfs_mount) == 0)
   {
-    debug(VFSSYSCALL, "(open)current_dentry->getInode() \n");
-    Inode* current_inode = pw_dentry->getInode();
-    debug(VFSSYSCALL, "(open) current_inode->getSuperblock()\n");
-    Superblock* current_sb = current_inode->getSuperblock();
+    // opening an existing file only looks the dentry up, it does not wait for other lookups
+    ScopedReadLock rl(vfs_lock);
+    if (dupChecking(pathname, pw_dentry, pw_vfs_mount) == 0)
+      return openDentry(pw_dentry, flag);
+  }
+  if (!(flag & O_CREAT))
+    return -1;
 
-    if (current_inode->getType() != I_FILE)
-    {
-      debug(VFSSYSCALL, "(open) Error: This path is not a file\n");
-      return -1;
-    }
+  ScopedWriteLock wl(vfs_lock);
+  // somebody may have created the file while the lock was not held
+  if (dupChecking(pathname, pw_dentry, pw_vfs_mount) == 0)
+    return openDentry(pw_dentry, flag);
 
-    int32 fd = current_sb->createFd(current_inode, flag & 0xFFFFFFFB);
-    debug(VFSSYSCALL, "the fd-num: %d, flag: %d\n", fd, flag);
+  debug(VFSSYSCALL, "(open) create a new file\n");
+  uint32 len = fs_info->pathname_.find_last_of("/");
+  ustl::string sub_dentry_name = fs_info->pathname_.substr(len+1, fs_info->pathname_.length() - len);
+  // set directory
+  fs_info->pathname_ = fs_info->pathname_.substr(0, len);
 
-    return fd;
-  }
-  else if (flag & O_CREAT)
+  pw_dentry = 0;
+  pw_vfs_mount = 0;
+  int32 success = PathWalker::pathWalk(fs_info->pathname_.c_str(), 0, pw_dentry, pw_vfs_mount);
+
+  if (success != 0)
   {
-    debug(VFSSYSCALL, "(open) create a new file\n");
-    uint32 len = fs_info->pathname_.find_last_of("/");
-    ustl::string sub_dentry_name = fs_info->pathname_.substr(len+1, fs_info->pathname_.length() - len);
-    // set directory
-    fs_info->pathname_ = fs_info->pathname_.substr(0, len);
+    debug(VFSSYSCALL, "(open) path_walker failed\n\n");
+    return -1;
+  }
 
-    Dentry* pw_dentry = 0;
-    VfsMount* pw_vfs_mount = 0;
-    int32 success = PathWalker::pathWalk(fs_info->pathname_.c_str(), 0, pw_dentry, pw_vfs_mount);
+  Inode* current_inode = pw_dentry->getInode();
+  Superblock* current_sb = current_inode->getSuperblock();
 
-    if (success != 0)
-    {
-      debug(VFSSYSCALL, "(open) path_walker failed\n\n");
-      return -1;
-    }
+  if (current_inode->getType() != I_DIR)
+  {
+    debug(VFSSYSCALL, "(open) Error: This path is not a directory\n\n");
+    return -1;
+  }
 
-    Inode* current_inode = pw_dentry->getInode();
-    Superblock* current_sb = current_inode->getSuperblock();
+  // create a new dentry
+  Dentry *sub_dentry = new Dentry(pw_dentry);
+  sub_dentry->d_name_ = sub_dentry_name;
+  sub_dentry->setParent(pw_dentry);
+  debug(VFSSYSCALL, "(open) calling create Inode\n");
+  Inode* sub_inode = current_sb->createInode(sub_dentry, I_FILE);
+  if (!sub_inode)
+  {
+    delete sub_dentry;
+    return -1;
+  }
+  debug(VFSSYSCALL, "(open) created Inode with dentry name %s\n", sub_inode->getDentry()->getName());
 
-    if (current_inode->getType() != I_DIR)
-    {
-      debug(VFSSYSCALL, "(open) Error: This path is not a directory\n\n");
-      return -1;
-    }
+  MutexLock ml(open_files_lock);
+  int32 fd = current_sb->createFd(sub_inode, flag & 0xFFFFFFFB);
+  debug(VFSSYSCALL, "the fd-num: %d\n", fd);
 
-    // create a new dentry
-    Dentry *sub_dentry = new Dentry(pw_dentry);
-    sub_dentry->d_name_ = sub_dentry_name;
-    sub_dentry->setParent(pw_dentry);
-    debug(VFSSYSCALL, "(open) calling create Inode\n");
-    Inode* sub_inode = current_sb->createInode(sub_dentry, I_FILE);
-    if (!sub_inode)
-    {
-      delete sub_dentry;
-      return -1;
-    }
-    debug(VFSSYSCALL, "(open) created Inode with dentry name %s\n", sub_inode->getDentry()->getName());
+  return fd;
+}
 
-    int32 fd = current_sb->createFd(sub_inode, flag & 0xFFFFFFFB);
-    debug(VFSSYSCALL, "the fd-num: %d\n", fd);
+int32 VfsSyscall::openDentry(Dentry* dentry, uint32 flag)
+{
+  debug(VFSSYSCALL, "(open)current_dentry->getInode() \n");
+  Inode* current_inode = dentry->getInode();
+  debug(VFSSYSCALL, "(open) current_inode->getSuperblock()\n");
+  Superblock* current_sb = current_inode->getSuperblock();
 
-    return fd;
-  }
-  else
+  if (current_inode->getType() != I_FILE)
+  {
+    debug(VFSSYSCALL, "(open) Error: This path is not a file\n");
     return -1;
+  }
+
+  MutexLock ml(open_files_lock);
+  int32 fd = current_sb->createFd(current_inode, flag & 0xFFFFFFFB);
+  debug(VFSSYSCALL, "the fd-num: %d, flag: %d\n", fd, flag);
+
+  return fd;
 }
 
 int32 VfsSyscall::read(uint32 fd, char* buffer, uint32 count)
@@ -10,10 +10,13 @@
 #include "BDManager.h"
 #include "BDVirtualDevice.h"
 #include "Thread.h"
+#include "RWLock.h"
+#include "RCU.h"
 
 #include "console/kprintf.h"
 
 VirtualFileSystem vfs;
+extern RWLock vfs_lock;
 
 void VirtualFileSystem::initialize()
 {
@@ -33,11 +36,12 @@ int32 VirtualFileSystem::registerFileSystem(FileSystemType *file_system_type)
   assert(file_system_type);
   assert(file_system_type->getFSName());
 
+  ScopedWriteLock wl(vfs_lock);
   // check whether a file system type with that name has already been
   // registered
   if (getFsType(file_system_type->getFSName()))
     return -1;
-  file_system_types_.push_back(file_system_type);
+  file_system_types_.pushBack(file_system_type);
   return 0;
 }
 
@@ -45,11 +49,17 @@ int32 VirtualFileSystem::unregisterFileSystem(FileSystemType *file_system_type)
 {
   assert(file_system_type != 0);
 
+  ScopedWriteLock wl(vfs_lock);
   const char *fs_name = file_system_type->getFSName();
-  for (FileSystemType* fst : file_system_types_)
+  for (FileSystemType* fst : file_system_types_.read())
   {
     if (strcmp(fst->getFSName(), fs_name) == 0)
-      delete fst;
+    {
+      // readers may still be looking at the type
+      file_system_types_.remove(fst);
+      RCU::instance()->deferDelete(fst);
+      break;
+    }
   }
   return 0;
 }
@@ -58,7 +68,8 @@ FileSystemType *VirtualFileSystem::getFsType(const char* fs_name)
 {
   assert(fs_name);
 
-  for (FileSystemType* fst : file_system_types_)
+  RCUReadLock rl;
+  for (FileSystemType* fst : file_system_types_.read())
   {
     if (strcmp(fst->getFSName(), fs_name) == 0)
       return fst;
@@ -72,7 +83,8 @@ VfsMount *VirtualFileSystem::getVfsMount(const Dentry* dentry, bool is_root)
 
   if (is_root == false)
   {
-    for (VfsMount* mnt : mounts_)
+    RCUReadLock rl;
+    for (VfsMount* mnt : mounts_.read())
     {
       debug(VFS, "getVfsMount> mnt->getMountPoint()->getName() : %s\n", mnt->getMountPoint()->getName());
       if (!is_root && (mnt->getMountPoint()) == dentry)
@@ -87,6 +99,7 @@ VfsMount *VirtualFileSystem::getVfsMount(const Dentry* dentry, bool is_root)
 FileSystemInfo *VirtualFileSystem::root_mount(const char *fs_name, uint32 /*flags*/)
 {
   FileSystemType *fst = getFsType(fs_name);
+  ScopedWriteLock wl(vfs_lock);
 
   Superblock *super = fst->createSuper(0, -1);
   super = fst->readSuper(super, 0);
@@ -96,7 +109,7 @@ FileSystemInfo *VirtualFileSystem::root_mount(const char *fs_name, uint32 /*flag
 
   VfsMount *root_mount = new VfsMount(0, mount_point, root, super, 0);
 
-  mounts_.push_back(root_mount);
+  mounts_.pushBack(root_mount);
   superblocks_.push_back(super);
 
   // fs_info initialize
@@ -128,6 +141,7 @@ int32 VirtualFileSystem::mount(const char* dev_name, const char* dir_name, const
   if (!fst)
     return -1;
 
+  ScopedWriteLock wl(vfs_lock);
   fs_info->pathname_ = dir_name;
   Dentry* pw_dentry = 0;
   VfsMount* pw_vfs_mount = 0;
@@ -149,7 +163,7 @@ int32 VirtualFileSystem::mount(const char* dev_name, const char* dir_name, const
 
   // create a new vfs_mount
   VfsMount *std_mount = new VfsMount(found_vfs_mount, found_dentry, root, super, 0);
-  mounts_.push_back(std_mount);
+  mounts_.pushBack(std_mount);
   superblocks_.push_back(super);
   return 0;
 }
@@ -160,7 +174,7 @@ int32 VirtualFileSystem::rootUmount()
   {
     return -1;
   }
-  VfsMount *root_vfs_mount = mounts_.at(0);
+  VfsMount *root_vfs_mount = *mounts_.read().begin();
   delete root_vfs_mount;
 
   Superblock *root_sb = superblocks_.at(0);
@@ -174,6 +188,7 @@ int32 VirtualFileSystem::umount(const char* dir_name, uint32 /*flags*/)
   if (dir_name == 0)
     return -1;
 
+  ScopedWriteLock wl(vfs_lock);
   fs_info->pathname_ = dir_name;
   Dentry* pw_dentry = 0;
   VfsMount* pw_vfs_mount = 0;
@@ -212,9 +227,10 @@ int32 VirtualFileSystem::umount(const char* dir_name, uint32 /*flags*/)
 
   Superblock *sb = found_vfs_mount->getSuperblock();
 
+  // path walks which started before may still be in the file system
   mounts_.remove(found_vfs_mount);
-  delete found_vfs_mount;
-  delete sb;
+  RCU::instance()->deferDelete(found_vfs_mount);
+  RCU::instance()->deferDelete(sb);
 
   return 0;
 }
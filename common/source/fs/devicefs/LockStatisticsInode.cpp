@@ -0,0 +1,41 @@
+/**
+ * @file LockStatisticsInode.cpp
+ */
+
+#include "fs/devicefs/LockStatisticsInode.h"
+#include "fs/Inode.h"
+#include "Lock.h"
+#include "kstring.h"
+
+LockStatisticsInode::LockStatisticsInode(Superblock *super_block) :
+    RamFSInode(super_block, I_FILE)
+{
+  i_size_ = LOCK_STATISTICS_REPORT_SIZE;
+}
+
+int32 LockStatisticsInode::mknod(Dentry *dentry)
+{
+  return mkfile(dentry);
+}
+
+int32 LockStatisticsInode::readData(uint32 offset, uint32 size, char *buffer)
+{
+  char* report = new char[LOCK_STATISTICS_REPORT_SIZE];
+  size_t length = Lock::writeContentionStatistics(report, LOCK_STATISTICS_REPORT_SIZE);
+  uint32 count = 0;
+  if (offset < length)
+  {
+    count = length - offset;
+    if (count > size)
+      count = size;
+    memcpy(buffer, report + offset, count);
+  }
+  delete[] report;
+  return count;
+}
+
+int32 LockStatisticsInode::writeData(uint32 __attribute__((unused)) offset, uint32 __attribute__((unused)) size,
+                                     const char __attribute__((unused)) *buffer)
+{
+  return -1;
+}
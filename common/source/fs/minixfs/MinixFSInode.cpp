@@ -1,12 +1,34 @@
 #include "MinixFSInode.h"
 #ifndef EXE2MINIXFS
 #include "kstring.h"
+#include "Mutex.h"
+#include "SlabAllocator.h"
 #endif
 #include <assert.h>
 #include "MinixFSSuperblock.h"
 #include "MinixFSFile.h"
 #include "Dentry.h"
 
+/**
+ * directories are loaded lazily by lookup(), i.e. while the vfs_lock is only held for reading,
+ * so lookups of the same directory have to load it one after the other
+ */
+Mutex load_children_lock("MinixFSInode::load_children_lock");
+
+#ifndef EXE2MINIXFS
+static SlabCache* inode_cache;
+
+void* MinixFSInode::operator new(size_t size)
+{
+  return SlabAllocator::instance()->getCache(inode_cache, "MinixFSInode", sizeof(MinixFSInode))->allocate(size);
+}
+
+void MinixFSInode::operator delete(void* address, size_t size)
+{
+  inode_cache->free(address, size);
+}
+#endif
+
 MinixFSInode::MinixFSInode(Superblock *super_block, uint32 inode_type) :
     Inode(super_block, inode_type), i_zones_(0), i_num_(0), children_loaded_(false)
 {
@@ -395,6 +417,10 @@ void MinixFSInode::loadChildren()
     debug(M_INODE, "loadChildren: Children allready loaded\n");
     return;
   }
+  MutexLock ml(load_children_lock);
+  // children_loaded_ is set after all children are on the list, check again whether somebody was faster
+  if (children_loaded_)
+    return;
   char dbuffer[ZONE_SIZE];
   for (uint32 zone = 0; zone < i_zones_->getNumZones(); zone++)
   {
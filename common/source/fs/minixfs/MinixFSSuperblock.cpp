@@ -353,7 +353,7 @@ int32 MinixFSSuperblock::removeFd(Inode* inode, FileDescriptor* fd)
   {
     used_inodes_.remove(inode);
   }
-  delete fd;
+  FileDescriptor::destroy(fd);
 
   return tmp;
 }
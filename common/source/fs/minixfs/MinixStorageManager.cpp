@@ -60,18 +60,16 @@ uint32 MinixStorageManager::getNumUsedInodes()
 
 size_t MinixStorageManager::allocZone()
 {
-  size_t pos = curr_zone_pos_ + 1;
-  for (; pos != curr_zone_pos_; pos++)
+  // from the last one on, then from the start
+  size_t pos = zone_bitmap_.findFirstZero(curr_zone_pos_ + 1);
+  if (pos == Bitmap::NOT_FOUND)
+    pos = zone_bitmap_.findFirstZero(0);
+  if (pos != Bitmap::NOT_FOUND)
   {
-    if (pos >= zone_bitmap_.getSize())
-      pos = 0;
-    if (!zone_bitmap_.getBit(pos))
-    {
-      zone_bitmap_.setBit(pos);
-      curr_zone_pos_ = pos;
-      debug(M_STORAGE_MANAGER, "acquireZone: Zone %zu acquired\n", pos);
-      return pos;
-    }
+    zone_bitmap_.setBit(pos);
+    curr_zone_pos_ = pos;
+    debug(M_STORAGE_MANAGER, "acquireZone: Zone %zu acquired\n", pos);
+    return pos;
   }
   kprintfd("acquireZone: NO FREE ZONE FOUND!\n");
   assert(false); // full memory should have been checked.
@@ -80,18 +78,16 @@ size_t MinixStorageManager::allocZone()
 
 size_t MinixStorageManager::allocInode()
 {
-  size_t pos = curr_inode_pos_ + 1;
-  for (; pos != curr_inode_pos_; pos++)
+  // from the last one on, then from the start
+  size_t pos = inode_bitmap_.findFirstZero(curr_inode_pos_ + 1);
+  if (pos == Bitmap::NOT_FOUND)
+    pos = inode_bitmap_.findFirstZero(0);
+  if (pos != Bitmap::NOT_FOUND)
   {
-    if (pos >= inode_bitmap_.getSize())
-      pos = 0;
-    if (!inode_bitmap_.getBit(pos))
-    {
-      inode_bitmap_.setBit(pos);
-      curr_inode_pos_ = pos;
-      debug(M_STORAGE_MANAGER, "acquireInode: Inode %zu acquired\n", pos);
-      return pos;
-    }
+    inode_bitmap_.setBit(pos);
+    curr_inode_pos_ = pos;
+    debug(M_STORAGE_MANAGER, "acquireInode: Inode %zu acquired\n", pos);
+    return pos;
   }
   kprintfd("acquireInode: NO FREE INODE FOUND!\n");
   assert(false); // full memory should have been checked.
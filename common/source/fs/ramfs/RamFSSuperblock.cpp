@@ -138,7 +138,7 @@ int32 RamFSSuperblock::removeFd(Inode* inode, FileDescriptor* fd)
   {
     used_inodes_.remove(inode);
   }
-  delete fd;
+  FileDescriptor::destroy(fd);
 
   return tmp;
 }
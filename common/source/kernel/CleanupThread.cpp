@@ -1,5 +1,6 @@
 #include "CleanupThread.h"
 #include "Scheduler.h"
+#include "RCU.h"
 
 CleanupThread::CleanupThread() : Thread(0, "CleanupThread")
 {
@@ -10,9 +11,11 @@ void CleanupThread::Run()
 {
   while (1)
   {
+    // a job is either a killed thread or a passed RCU grace period
     while (hasWork())
     {
       Scheduler::instance()->cleanupDeadThreads();
+      RCU::instance()->reclaim();
     }
     waitForNextJob();
   }
@@ -1,13 +1,12 @@
 #include "Condition.h"
 #include "Thread.h"
 #include "Mutex.h"
-#include "Scheduler.h"
 #include "assert.h"
 #include "kprintf.h"
 #include "debug.h"
 
 Condition::Condition(Mutex* mutex, const char* name) :
-  Lock(name), mutex_(mutex)
+  Lock(name), mutex_(mutex), sleepers_(name)
 {
 }
 
@@ -15,6 +14,35 @@ void Condition::wait(const char* debug_info, bool re_acquire_mutex)
 {
   if(unlikely(system_state != RUNNING))
     return;
+  checkBeforeSleeping(debug_info);
+  currentThread->lock_waiting_on_ = this;
+  sleepers_.wait(mutex_);
+  currentThread->lock_waiting_on_ = 0;
+  if(re_acquire_mutex)
+  {
+    assert(mutex_);
+    mutex_->acquire();
+  }
+}
+
+bool Condition::waitWithTimeout(size_t timeout_ticks, const char* debug_info, bool re_acquire_mutex)
+{
+  if(unlikely(system_state != RUNNING))
+    return true;
+  checkBeforeSleeping(debug_info);
+  currentThread->lock_waiting_on_ = this;
+  bool signaled = sleepers_.waitWithTimeout(timeout_ticks, mutex_);
+  currentThread->lock_waiting_on_ = 0;
+  if(re_acquire_mutex)
+  {
+    assert(mutex_);
+    mutex_->acquire();
+  }
+  return signaled;
+}
+
+void Condition::checkBeforeSleeping(const char* debug_info)
+{
   //debug(LOCK, "Condition::wait: Thread %s (%p) waiting on condition %s (%p).\n",
   //      currentThread->getName(), currentThread, getName(), this);
   assert(mutex_->isHeldBy(currentThread));
@@ -30,15 +58,6 @@ void Condition::wait(const char* debug_info, bool re_acquire_mutex)
           currentThread->getName(), currentThread, getName(), this);
     printHoldingList(currentThread);
   }
-  lockWaitersList();
-  // The mutex can be released here, because for waking up another thread, the list lock is needed, which is still held by the thread.
-  mutex_->release();
-  Scheduler::instance()->sleepAndRelease(*(Lock*)this);
-  if(re_acquire_mutex)
-  {
-    assert(mutex_);
-    mutex_->acquire();
-  }
 }
 
 void Condition::signal(const char* debug_info)
@@ -47,31 +66,9 @@ void Condition::signal(const char* debug_info)
     return;
   assert(mutex_->isHeldBy(currentThread));
   checkInterrupts("Condition::signal", debug_info);
-  lockWaitersList();
-  Thread* thread_to_be_woken_up = popBackThreadFromWaitersList();
-  unlockWaitersList();
-
-  if(thread_to_be_woken_up)
-  {
-    if(likely(thread_to_be_woken_up->state_ == Sleeping))
-    {
-      // In this case we can access the pointer of the other thread without locking,
-      // because we can ensure that the thread is sleeping.
-
-      //debug(LOCK, "Condition: Thread %s (%p) being signaled for condition %s (%p).\n",
-      //      thread_to_be_woken_up->getName(), thread_to_be_woken_up, getName(), this);
-      thread_to_be_woken_up->lock_waiting_on_ = 0;
-      Scheduler::instance()->wake(thread_to_be_woken_up);
-    }
-    else
-    {
-      debug(LOCK, "ERROR: Condition %s (%p): Thread %s (%p) is in state %s AND waiting on the condition!\n",
-            getName(), this, thread_to_be_woken_up->getName(), thread_to_be_woken_up,
-            Thread::threadStatePrintable[thread_to_be_woken_up->state_]);
-      if(debug_info) debug(LOCK, "Debug Info: %s\n", debug_info);
-      assert(false);
-    }
-  }
+  //debug(LOCK, "Condition: Thread %s (%p) signaling condition %s (%p).\n",
+  //      currentThread->getName(), currentThread, getName(), this);
+  sleepers_.wakeOne();
 }
 
 void Condition::broadcast(const char* debug_info)
@@ -79,9 +76,6 @@ void Condition::broadcast(const char* debug_info)
   if(unlikely(system_state != RUNNING))
     return;
   assert(mutex_->isHeldBy(currentThread));
-  // signal em all
-  while(threadsAreOnWaitersList())
-  {
-    signal(debug_info);
-  }
+  checkInterrupts("Condition::broadcast", debug_info);
+  sleepers_.wakeAll();
 }
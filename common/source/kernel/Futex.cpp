@@ -0,0 +1,122 @@
+#include "Futex.h"
+#include "WaitQueue.h"
+#include "Thread.h"
+#include "Loader.h"
+#include "ArchMemory.h"
+#include "kprintf.h"
+
+/**
+ * a thread waiting on a futex, lives on the stack of the waiting thread
+ */
+struct FutexWaiter
+{
+    FutexWaiter(uint64 key) :
+        key_(key), next_(0), queue_("FutexWaiter::queue_")
+    {
+    }
+
+    uint64 key_;
+    FutexWaiter* next_;
+    WaitQueue queue_;
+};
+
+Futex* Futex::instance_ = 0;
+
+Futex* Futex::instance()
+{
+  if (unlikely(!instance_))
+    instance_ = new Futex();
+  return instance_;
+}
+
+Futex::Futex()
+{
+}
+
+Futex::Bucket::Bucket() :
+    lock_("Futex::Bucket::lock_"), head_(0), tail_(0)
+{
+}
+
+bool Futex::getKey(pointer address, uint64& key)
+{
+  if (address % sizeof(uint32) || address >= 2U*1024U*1024U*1024U || !currentThread->loader_)
+    return false;
+
+  // reading the word loads the page in case it has not been accessed yet
+  volatile uint32 value = *(volatile uint32*) address;
+  (void) value;
+
+  size_t ppn;
+  size_t page_size = currentThread->loader_->arch_memory_.get_PPN_Of_VPN(address / PAGE_SIZE, &ppn);
+  if (!page_size)
+    return false;
+  key = (uint64) ppn * page_size + address % page_size;
+  return true;
+}
+
+Futex::Bucket& Futex::bucketOf(uint64 key)
+{
+  return buckets_[((key >> 2) ^ (key >> 12)) % FUTEX_HASH_BUCKETS];
+}
+
+ssize_t Futex::wait(pointer address, uint32 expected)
+{
+  uint64 key;
+  if (!getKey(address, key))
+    return -1;
+  Bucket& bucket = bucketOf(key);
+  FutexWaiter waiter(key);
+
+  bucket.lock_.acquire();
+  if (*(volatile uint32*) address != expected)
+  {
+    bucket.lock_.release();
+    return -1;
+  }
+  if (bucket.tail_)
+    bucket.tail_->next_ = &waiter;
+  else
+    bucket.head_ = &waiter;
+  bucket.tail_ = &waiter;
+  debug(LOCK, "Futex::wait: %s (%x) waits on %x (key %x)\n", currentThread->getName(), currentThread, address,
+        (size_t) key);
+  waiter.queue_.wait(&bucket.lock_);
+
+  // the waker takes the waiter off the bucket and wakes it up holding the bucket lock,
+  // the queue must not go out of scope before it is done
+  MutexLock lock(bucket.lock_);
+  return 0;
+}
+
+ssize_t Futex::wake(pointer address, size_t count)
+{
+  uint64 key;
+  if (!getKey(address, key))
+    return -1;
+  Bucket& bucket = bucketOf(key);
+
+  MutexLock lock(bucket.lock_);
+  ssize_t woken_up = 0;
+  FutexWaiter* previous = 0;
+  FutexWaiter* waiter = bucket.head_;
+  while (waiter && (size_t) woken_up < count)
+  {
+    FutexWaiter* next = waiter->next_;
+    if (waiter->key_ == key)
+    {
+      if (previous)
+        previous->next_ = next;
+      else
+        bucket.head_ = next;
+      if (bucket.tail_ == waiter)
+        bucket.tail_ = previous;
+      waiter->queue_.wakeOne();
+      ++woken_up;
+    }
+    else
+      previous = waiter;
+    waiter = next;
+  }
+  return woken_up;
+}
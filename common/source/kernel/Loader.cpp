@@ -125,6 +125,9 @@ void Loader::loadOnePageSafeButSlow ( pointer virtual_address )
 
   debug ( LOADER,"loadOnePageSafeButSlow: going to load virtual page %d (virtual_address=%d) for %d:%s\n",virtual_page,virtual_address,currentThread->getTID(),currentThread->getName() );
 
+  if (loadHugePage(virtual_address))
+    return;
+
   debug ( LOADER,"loadOnePage: Num ents: %d\n",hdr_->e_phnum );
   debug ( LOADER,"loadOnePage: Entry: %x\n",hdr_->e_entry );
 
@@ -265,6 +268,34 @@ void Loader::loadOnePageSafeButSlow ( pointer virtual_address )
 }
 
 
+bool Loader::loadHugePage(pointer virtual_address)
+{
+  size_t huge_page_size = ArchMemory::HUGE_PAGE_SIZE;
+  if (!huge_page_size)
+    return false;
+  pointer start = virtual_address & ~((pointer) huge_page_size - 1);
+  pointer end = start + huge_page_size;
+  // the null page has to stay unmapped
+  if (start == 0)
+    return false;
+
+  bool in_bss = false;
+  for (size_t k = 0; k < hdr_->e_phnum; ++k)
+  {
+    Elf::Phdr& h = phdrs_[k];
+    if (end <= h.p_paddr || start >= h.p_paddr + h.p_memsz)
+      continue;
+    if (start < h.p_paddr + h.p_filesz || end > h.p_paddr + h.p_memsz)
+      return false;
+    in_bss = true;
+  }
+  if (!in_bss)
+    return false;
+
+  debug(LOADER, "loadHugePage: %x to %x is in .bss\n", start, end);
+  return arch_memory_.mapHugePage(start / PAGE_SIZE, true);
+}
+
 bool Loader::loadDebugInfoIfAvailable()
 {
   debug(USERTRACE, "loadDebugInfoIfAvailable start\n");
@@ -5,18 +5,46 @@
 #include "ArchThreads.h"
 #include "ArchInterrupts.h"
 #include "Scheduler.h"
+#include "ArchCommon.h"
+#include "ustringformat.h"
+#include "LockDep.h"
+
+Lock* Lock::all_locks_ = 0;
 
 Lock::Lock(const char *name) :
   held_by_(0),
   next_lock_on_holding_list_(0),
+  priority_inheritance_(false),
   name_(name ? name : ""),
   waiters_list_(0),
-  waiters_list_lock_(0)
+  waiters_list_lock_(0),
+  acquired_cycles_(0),
+  next_lock_(0),
+  previous_lock_(0),
+  lock_class_(0)
 {
+  memset(&statistics_, 0, sizeof(statistics_));
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  next_lock_ = all_locks_;
+  if(all_locks_)
+    all_locks_->previous_lock_ = this;
+  all_locks_ = this;
+  if(interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
 }
 
 Lock::~Lock()
 {
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  if(previous_lock_)
+    previous_lock_->next_lock_ = next_lock_;
+  else if(all_locks_ == this)
+    all_locks_ = next_lock_;
+  if(next_lock_)
+    next_lock_->previous_lock_ = previous_lock_;
+  if(interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
+
   if(unlikely(system_state != RUNNING))
     return;
   // copy the pointers to the stack because it may be reseted before printing the element out.
@@ -69,6 +97,7 @@ void Lock::pushFrontToCurrentThreadHoldingList()
 
 void Lock::checkForDeadLock(const char* debug_info)
 {
+#if LOCKDEP
   if(!currentThread)
     return;
   if(held_by_ == currentThread)
@@ -79,7 +108,12 @@ void Lock::checkForDeadLock(const char* debug_info)
 
     assert(false);
   }
-  checkForCircularDeadLock(currentThread, this, debug_info);
+  // waiting in a known consistent order cannot close a cycle of waiting threads
+  if(!LockDep::checkOrder(currentThread->holding_lock_list_, this))
+    checkForCircularDeadLock(currentThread, this, debug_info);
+#else
+  (void) debug_info;
+#endif
 }
 
 void Lock::removeFromCurrentThreadHoldingList()
@@ -196,7 +230,7 @@ void Lock::lockWaitersList()
   // The waiters list lock is a simple spinlock.
   // Just wait until the holding thread is releasing the lock,
   // and acquire it. These steps have to be atomic.
-  while(ArchThreads::testSetLock(waiters_list_lock_, 1))
+  while(waiters_list_lock_.exchange(1, MEMORY_ORDER_ACQUIRE))
   {
     Scheduler::instance()->yield();
   }
@@ -204,7 +238,7 @@ void Lock::lockWaitersList()
 
 void Lock::unlockWaitersList()
 {
-  waiters_list_lock_ = 0;
+  waiters_list_lock_.store(0, MEMORY_ORDER_RELEASE);
 }
 
 void Lock::pushFrontCurrentThreadToWaitersList()
@@ -277,6 +311,20 @@ void Lock::removeCurrentThreadFromWaitersList()
   return;
 }
 
+bool Lock::removeCurrentThreadFromWaitersListIfWaiting()
+{
+  assert(waitersListIsLocked());
+  for(Thread* thread = waiters_list_; thread != 0; thread = thread->next_thread_in_lock_waiters_list_)
+  {
+    if(thread == currentThread)
+    {
+      removeCurrentThreadFromWaitersList();
+      return true;
+    }
+  }
+  return false;
+}
+
 void Lock::checkInvalidRelease(const char* method, const char* debug_info)
 {
   if(unlikely(held_by_ != currentThread))
@@ -293,3 +341,127 @@ void Lock::checkInvalidRelease(const char* method, const char* debug_info)
     assert(false);
   }
 }
+
+uint64 Lock::contentionStart()
+{
+  return LOCK_STATISTICS ? ArchCommon::getCycleCount() : 0;
+}
+
+void Lock::recordAcquisition(uint64 wait_start, bool exclusive, WaitPath path)
+{
+  if(!LOCK_STATISTICS)
+    return;
+  uint64 now = ArchCommon::getCycleCount();
+  ++statistics_.acquisitions;
+  if(wait_start)
+  {
+    uint64 wait_cycles = now - wait_start;
+    ++statistics_.contended_acquisitions;
+    statistics_.wait_cycles += wait_cycles;
+    if(wait_cycles > statistics_.max_wait_cycles)
+      statistics_.max_wait_cycles = wait_cycles;
+    if(path == WAIT_SPIN)
+      ++statistics_.spin_acquisitions;
+    else if(path == WAIT_YIELD)
+      ++statistics_.yield_acquisitions;
+    else if(path == WAIT_SLEEP)
+      ++statistics_.sleep_acquisitions;
+  }
+  if(exclusive)
+    acquired_cycles_ = now;
+}
+
+void Lock::recordRelease()
+{
+  if(!LOCK_STATISTICS || !acquired_cycles_)
+    return;
+  uint64 hold_cycles = ArchCommon::getCycleCount() - acquired_cycles_;
+  acquired_cycles_ = 0;
+  statistics_.hold_cycles += hold_cycles;
+  if(hold_cycles > statistics_.max_hold_cycles)
+    statistics_.max_hold_cycles = hold_cycles;
+}
+
+size_t Lock::getTopContention(Statistics* top, size_t count)
+{
+  size_t found = 0;
+  // the list must not change while walking it, the copies are taken with interrupts disabled
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  for(Lock* lock = all_locks_; lock != 0; lock = lock->next_lock_)
+  {
+    if(!lock->statistics_.acquisitions)
+      continue;
+    // insertion sort into the (short) array of the longest waits
+    size_t position = found;
+    while(position > 0 && top[position - 1].wait_cycles < lock->statistics_.wait_cycles)
+    {
+      if(position < count)
+        top[position] = top[position - 1];
+      --position;
+    }
+    if(position >= count)
+      continue;
+    top[position] = lock->statistics_;
+    top[position].lock = lock;
+    top[position].name = lock->name_;
+    if(found < count)
+      ++found;
+  }
+  if(interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
+  return found;
+}
+
+/**
+ * the format of a line of the contention report
+ */
+static const char* const contention_format =
+    "%s (%p): %d acquired, %d contended (%d spinning, %d yielding, %d sleeping), wait %d cycles (max %d), "
+    "hold %d cycles (max %d)\n";
+
+void Lock::printContentionStatistics()
+{
+  Statistics top[LOCK_STATISTICS_TOP_N];
+  size_t count = getTopContention(top, LOCK_STATISTICS_TOP_N);
+  debug(LOCK, "Lock::printContentionStatistics: the %d locks waited on the longest:\n", count);
+  for(size_t i = 0; i < count; ++i)
+  {
+    kprintfd(contention_format, top[i].name, top[i].lock, (size_t) top[i].acquisitions,
+             (size_t) top[i].contended_acquisitions, (size_t) top[i].spin_acquisitions,
+             (size_t) top[i].yield_acquisitions, (size_t) top[i].sleep_acquisitions,
+             (size_t) top[i].wait_cycles, (size_t) top[i].max_wait_cycles,
+             (size_t) top[i].hold_cycles, (size_t) top[i].max_hold_cycles);
+  }
+}
+
+/**
+ * appends to a text buffer, see Lock::writeContentionStatistics()
+ */
+static void appendFormatted(char* buffer, size_t size, size_t& length, const char* format, ...)
+{
+  if(length + 1 >= size)
+    return;
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buffer + length, size - length, format, args);
+  va_end(args);
+  length += strlen(buffer + length);
+}
+
+size_t Lock::writeContentionStatistics(char* buffer, size_t size)
+{
+  if(!size)
+    return 0;
+  Statistics top[LOCK_STATISTICS_TOP_N];
+  size_t count = getTopContention(top, LOCK_STATISTICS_TOP_N);
+  size_t length = 0;
+  buffer[0] = 0;
+  for(size_t i = 0; i < count; ++i)
+  {
+    appendFormatted(buffer, size, length, contention_format, top[i].name, top[i].lock, (size_t) top[i].acquisitions,
+                    (size_t) top[i].contended_acquisitions, (size_t) top[i].spin_acquisitions,
+                    (size_t) top[i].yield_acquisitions, (size_t) top[i].sleep_acquisitions, (size_t) top[i].wait_cycles,
+                    (size_t) top[i].max_wait_cycles, (size_t) top[i].hold_cycles, (size_t) top[i].max_hold_cycles);
+  }
+  return length;
+}
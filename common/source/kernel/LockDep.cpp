@@ -0,0 +1,168 @@
+#include "LockDep.h"
+#include "Lock.h"
+#include "ArchInterrupts.h"
+#include "kprintf.h"
+#include "kstring.h"
+
+LockDep::LockClass LockDep::classes_[LOCKDEP_MAX_CLASSES];
+size_t LockDep::num_classes_ = 0;
+LockDep::LockOrder LockDep::orders_[LOCKDEP_MAX_ORDERS];
+size_t LockDep::num_orders_ = 0;
+size_t LockDep::num_inversions_ = 0;
+uint16 LockDep::order_hash_[LOCKDEP_HASH_SIZE];
+uint32 LockDep::visited_[LOCKDEP_MAX_CLASSES];
+uint16 LockDep::parent_[LOCKDEP_MAX_CLASSES];
+uint16 LockDep::search_stack_[LOCKDEP_MAX_CLASSES];
+uint32 LockDep::search_generation_ = 0;
+bool LockDep::full_reported_ = false;
+
+static uint32 hashName(const char* name)
+{
+  // FNV-1a
+  uint32 hash = 2166136261U;
+  for (; *name; ++name)
+    hash = (hash ^ (uint8) *name) * 16777619U;
+  return hash;
+}
+
+static size_t hashOrder(size_t from, size_t to)
+{
+  return ((from * LOCKDEP_MAX_CLASSES + to) * 2654435761U) & (LOCKDEP_HASH_SIZE - 1);
+}
+
+size_t LockDep::getClass(Lock* lock)
+{
+  if (lock->lock_class_)
+    return lock->lock_class_;
+  // locks with the same name belong to the same class, even if the strings are not merged
+  const char* name = lock->getName();
+  uint32 hash = hashName(name);
+  for (size_t i = 0; i < num_classes_; ++i)
+  {
+    if (classes_[i].hash == hash && !strcmp(classes_[i].name, name))
+      return lock->lock_class_ = i + 1;
+  }
+  if (num_classes_ == LOCKDEP_MAX_CLASSES)
+    return 0;
+  classes_[num_classes_].name = name;
+  classes_[num_classes_].hash = hash;
+  classes_[num_classes_].first_order = 0;
+  return lock->lock_class_ = ++num_classes_;
+}
+
+bool LockDep::hasPath(size_t start, size_t target)
+{
+  ++search_generation_;
+  size_t depth = 0;
+  search_stack_[depth++] = start;
+  visited_[start] = search_generation_;
+  while (depth)
+  {
+    size_t current = search_stack_[--depth];
+    if (current == target)
+      return true;
+    for (size_t order = classes_[current].first_order; order; order = orders_[order - 1].next_order)
+    {
+      size_t next = orders_[order - 1].to;
+      if (visited_[next] == search_generation_)
+        continue;
+      // every class is pushed at most once, the stack cannot overflow
+      visited_[next] = search_generation_;
+      parent_[next] = current;
+      search_stack_[depth++] = next;
+    }
+  }
+  return false;
+}
+
+void LockDep::printPath(size_t start, size_t target)
+{
+  // hasPath() left the parents of the path behind, it is printed from the target back to the start
+  for (size_t current = target; current != start; current = parent_[current])
+    kprintfd("  %s is taken while holding %s\n", classes_[current].name, classes_[parent_[current]].name);
+}
+
+size_t LockDep::findOrder(size_t from, size_t to)
+{
+  size_t slot = hashOrder(from, to);
+  for (size_t order; (order = order_hash_[slot]); slot = (slot + 1) & (LOCKDEP_HASH_SIZE - 1))
+  {
+    if (orders_[order - 1].from == from && orders_[order - 1].to == to)
+      return order;
+  }
+  return 0;
+}
+
+void LockDep::markNeedsWalk(size_t from, size_t to)
+{
+  size_t order = findOrder(from, to);
+  if (order)
+    orders_[order - 1].needs_walk = true;
+}
+
+bool LockDep::checkPair(size_t from, size_t to)
+{
+  // nested locks of the same class are not ordered by the graph
+  if (from == to)
+    return false;
+
+  size_t known = findOrder(from, to);
+  if (known)
+    return !orders_[known - 1].needs_walk;
+
+  // a new pair, validated once
+  if (num_orders_ == LOCKDEP_MAX_ORDERS)
+    return false;
+  size_t slot = hashOrder(from, to);
+  while (order_hash_[slot])
+    slot = (slot + 1) & (LOCKDEP_HASH_SIZE - 1);
+  LockOrder& order = orders_[num_orders_++];
+  order.from = from;
+  order.to = to;
+  order.needs_walk = hasPath(to, from);
+  order_hash_[slot] = num_orders_;
+  // the order is linked even if it is inverted, it may close other cycles later on
+  order.next_order = classes_[from].first_order;
+  classes_[from].first_order = num_orders_;
+  if (order.needs_walk)
+  {
+    ++num_inversions_;
+    debug(LOCK, "LockDep: lock order inversion, %s is taken while holding %s, but before:\n", classes_[to].name,
+          classes_[from].name);
+    printPath(to, from);
+    // none of the orders of the cycle may be trusted any more, hasPath() left the path in parent_
+    markNeedsWalk(to, from);
+    for (size_t current = from; current != to; current = parent_[current])
+      markNeedsWalk(parent_[current], current);
+    return false;
+  }
+  return true;
+}
+
+bool LockDep::checkOrder(Lock* holding_list, Lock* acquiring)
+{
+  if (!holding_list)
+    return true;
+  bool consistent = true;
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  size_t to = getClass(acquiring);
+  for (Lock* held = holding_list; held != 0 && consistent; held = held->next_lock_on_holding_list_)
+  {
+    size_t from = getClass(held);
+    consistent = from && to && checkPair(from - 1, to - 1);
+  }
+  bool tables_full = !full_reported_ && (num_classes_ == LOCKDEP_MAX_CLASSES || num_orders_ == LOCKDEP_MAX_ORDERS);
+  if (tables_full)
+    full_reported_ = true;
+  if (interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
+  if (tables_full)
+    debug(LOCK, "LockDep: the tables are full, new lock orders are checked by walking the waiting threads\n");
+  return consistent;
+}
+
+void LockDep::printStatistics()
+{
+  debug(LOCK, "LockDep: %d lock classes, %d lock orders, %d inversions\n", num_classes_, num_orders_,
+        num_inversions_);
+}
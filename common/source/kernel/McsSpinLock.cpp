@@ -0,0 +1,99 @@
+#include "McsSpinLock.h"
+#include "TicketSpinLock.h"
+#include "ArchThreads.h"
+#include "ArchInterrupts.h"
+#include "Scheduler.h"
+#include "Thread.h"
+#include "kprintf.h"
+#include "assert.h"
+
+/**
+ * one round of busy waiting, yields now and then in case the thread we wait for
+ * has been preempted on this CPU
+ */
+static void spinOnce(size_t& spins)
+{
+  ArchThreads::spinLoopHint();
+  if (++spins >= SPINLOCK_YIELD_ITERATIONS && system_state == RUNNING && ArchInterrupts::testIFSet())
+  {
+    Scheduler::instance()->yield();
+    spins = 0;
+  }
+}
+
+McsSpinLock::McsSpinLock(const char* name) :
+    name_(name), tail_(0), held_by_(0)
+{
+}
+
+void McsSpinLock::acquire(McsNode& node)
+{
+  if (unlikely(currentThread && held_by_ == currentThread))
+  {
+    debug(LOCK, "McsSpinLock::acquire: ERROR: %s (%p) is already held by thread %s (%p), "
+          "maybe it is shared with an interrupt handler but not taken with acquireIrqSave\n",
+          name_, this, currentThread->getName(), currentThread);
+    assert(false);
+  }
+  node.next.store(0, MEMORY_ORDER_RELAXED);
+  node.locked.store(1, MEMORY_ORDER_RELAXED);
+  // the node has to be initialised before a successor can find it, the critical section of the
+  // predecessor has to be visible once we are handed the lock
+  McsNode* predecessor = tail_.exchange(&node, MEMORY_ORDER_ACQ_REL);
+  if (predecessor)
+  {
+    predecessor->next.store(&node, MEMORY_ORDER_RELEASE);
+    size_t spins = 0;
+    while (node.locked.load(MEMORY_ORDER_ACQUIRE))
+      spinOnce(spins);
+  }
+  held_by_ = currentThread;
+}
+
+bool McsSpinLock::acquireNonBlocking(McsNode& node)
+{
+  node.next.store(0, MEMORY_ORDER_RELAXED);
+  node.locked.store(0, MEMORY_ORDER_RELAXED);
+  McsNode* expected = 0;
+  if (!tail_.compareExchange(expected, &node, MEMORY_ORDER_ACQ_REL))
+    return false;
+  held_by_ = currentThread;
+  return true;
+}
+
+void McsSpinLock::release(McsNode& node)
+{
+  held_by_ = 0;
+  McsNode* successor = node.next.load(MEMORY_ORDER_ACQUIRE);
+  if (!successor)
+  {
+    // no successor yet, try to leave the lock free
+    McsNode* expected = &node;
+    if (tail_.compareExchange(expected, 0, MEMORY_ORDER_RELEASE))
+      return;
+    // a successor has already swapped itself in, but not linked itself to the node yet
+    size_t spins = 0;
+    while (!(successor = node.next.load(MEMORY_ORDER_ACQUIRE)))
+      spinOnce(spins);
+  }
+  successor->locked.store(0, MEMORY_ORDER_RELEASE);
+}
+
+bool McsSpinLock::acquireIrqSave(McsNode& node)
+{
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  acquire(node);
+  return interrupts_enabled;
+}
+
+void McsSpinLock::releaseIrqRestore(McsNode& node, bool interrupts_enabled)
+{
+  release(node);
+  if (interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
+}
+
+bool McsSpinLock::isFree()
+{
+  return tail_.load(MEMORY_ORDER_RELAXED) == 0;
+}
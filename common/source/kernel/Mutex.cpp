@@ -5,10 +5,12 @@
 #include "Scheduler.h"
 #include "Thread.h"
 #include "panic.h"
+#include "TimerWheel.h"
 
 Mutex::Mutex(const char* name) :
   Lock::Lock(name), mutex_(0)
 {
+  priority_inheritance_ = true;
 }
 
 bool Mutex::acquireNonBlocking(const char* debug_info)
@@ -23,7 +25,7 @@ bool Mutex::acquireNonBlocking(const char* debug_info)
   // So in case you see this comment, re-think your implementation and don't just comment out this line!
   doChecksBeforeWaiting(debug_info);
 
-  if(ArchThreads::testSetLock(mutex_, 1))
+  if(mutex_.exchange(1, MEMORY_ORDER_ACQUIRE))
   {
     // The mutex is already held by another thread,
     // so we are not allowed to lock it.
@@ -32,35 +34,104 @@ bool Mutex::acquireNonBlocking(const char* debug_info)
   assert(held_by_ == 0);
   held_by_ = currentThread;
   pushFrontToCurrentThreadHoldingList();
+  recordAcquisition(0);
   return true;
 }
 
 void Mutex::acquire(const char* debug_info)
+{
+  doAcquire(debug_info, 0);
+}
+
+bool Mutex::acquireWithTimeout(size_t timeout_ticks, const char* debug_info)
+{
+  Timer timeout(timeout_ticks);
+  return doAcquire(debug_info, &timeout);
+}
+
+bool Mutex::doAcquire(const char* debug_info, Timer* timeout)
 {
   if(unlikely(system_state != RUNNING))
-    return;
+    return true;
   //debug(LOCK, "Mutex::acquire:  Mutex: %s (%p), currentThread: %s (%p).\n",
   //         getName(), this, currentThread->getName(), currentThread);
-  while(ArchThreads::testSetLock(mutex_, 1))
+  bool contended = mutex_.exchange(1, MEMORY_ORDER_ACQUIRE);
+  uint64 wait_start = contended ? contentionStart() : 0;
+  WaitPath path = WAIT_SLEEP;
+  if(contended && !acquireWithoutSleeping(path))
   {
-    checkCurrentThreadStillWaitingOnAnotherLock(debug_info);
-    lockWaitersList();
-    // Here we have to check for the lock again, in case some one released it in between, we might sleep forever.
-    if(!ArchThreads::testSetLock(mutex_, 1))
+    do
     {
-      unlockWaitersList();
-      break;
-    }
-    // check for deadlocks, interrupts...
-    doChecksBeforeWaiting(debug_info);
-    Scheduler::instance()->sleepAndRelease(*(Lock*)this);
-    // We have been waken up again.
-    currentThread->lock_waiting_on_ = 0;
+      checkCurrentThreadStillWaitingOnAnotherLock(debug_info);
+      lockWaitersList();
+      // Here we have to check for the lock again, in case some one released it in between, we might sleep forever.
+      if(!mutex_.exchange(1, MEMORY_ORDER_ACQUIRE))
+      {
+        unlockWaitersList();
+        break;
+      }
+      // check for deadlocks, interrupts...
+      doChecksBeforeWaiting(debug_info);
+      // the holder must not be kept from releasing the mutex by threads less important than us
+      Scheduler::instance()->inheritPriority(this);
+      Scheduler::instance()->sleepAndRelease(*(Lock*)this, timeout);
+      // We have been waken up again.
+      if(timeout)
+      {
+        // release() wakes up the thread while holding the waiters list lock,
+        // so after locking it we know for sure whether we have been woken up by it
+        lockWaitersList();
+        bool timed_out = removeCurrentThreadFromWaitersListIfWaiting();
+        currentThread->sleep_timer_ = 0;
+        unlockWaitersList();
+        if(timed_out)
+        {
+          currentThread->lock_waiting_on_ = 0;
+          return false;
+        }
+      }
+      currentThread->lock_waiting_on_ = 0;
+    } while(mutex_.exchange(1, MEMORY_ORDER_ACQUIRE));
   }
+  if(timeout)
+    timeout->cancel();
 
   assert(held_by_ == 0);
   pushFrontToCurrentThreadHoldingList();
   held_by_ = currentThread;
+  recordAcquisition(wait_start, true, path);
+  return true;
+}
+
+bool Mutex::acquireWithoutSleeping(WaitPath& path)
+{
+  Scheduler* scheduler = Scheduler::instance();
+  Thread* holder = held_by_;
+  // spinning only makes sense while the holder can make progress on another CPU,
+  // on the single CPU the kernel runs on the holder is never running while we are
+  for(size_t i = 0; holder && holder != currentThread && scheduler->isRunning(holder) && i < MUTEX_SPIN_ITERATIONS; ++i)
+  {
+    ArchThreads::spinLoopHint();
+    if(!mutex_.load(MEMORY_ORDER_RELAXED) && !mutex_.exchange(1, MEMORY_ORDER_ACQUIRE))
+    {
+      path = WAIT_SPIN;
+      return true;
+    }
+    holder = held_by_;
+  }
+  // the holder has been preempted within its critical section, let it go on for a moment
+  holder = held_by_;
+  if(holder && holder != currentThread && holder->state_ == Running && !scheduler->isRunning(holder)
+     && ArchInterrupts::testIFSet())
+  {
+    scheduler->yield();
+    if(!mutex_.exchange(1, MEMORY_ORDER_ACQUIRE))
+    {
+      path = WAIT_YIELD;
+      return true;
+    }
+  }
+  return false;
 }
 
 void Mutex::release(const char* debug_info)
@@ -70,20 +141,24 @@ void Mutex::release(const char* debug_info)
   //debug(LOCK, "Mutex::release:  Mutex: %s (%p), currentThread: %s (%p).\n",
   //         getName(), this, currentThread->getName(), currentThread);
   checkInvalidRelease("Mutex::release", debug_info);
+  recordRelease();
   removeFromCurrentThreadHoldingList();
   held_by_ = 0;
-  mutex_ = 0;
+  mutex_.store(0, MEMORY_ORDER_RELEASE);
   // Wake up a sleeping thread. It is okay that the mutex is not held by the current thread any longer.
   // In worst case a new thread is woken up. Otherwise (first wake up, then release),
   // it could happen that a thread is going to sleep after the this one is trying to wake up one.
   // Then we are dead... (the thread may sleep forever, in case no other thread is going to acquire this mutex again).
+  // The thread is woken up before unlocking the waiters list, a thread waiting with timeout
+  // locks it after waking up to find out whether it has been woken up by us.
   lockWaitersList();
   Thread* thread_to_be_woken_up = popBackThreadFromWaitersList();
-  unlockWaitersList();
-  if(thread_to_be_woken_up)
+  if(thread_to_be_woken_up && thread_to_be_woken_up->state_ == Sleeping)
   {
     Scheduler::instance()->wake(thread_to_be_woken_up);
   }
+  unlockWaitersList();
+  Scheduler::instance()->restorePriority();
 }
 
 bool Mutex::isFree()
@@ -93,5 +168,5 @@ bool Mutex::isFree()
     debug(LOCK, "Mutex::isFree: ERROR: Should not be used with IF=1 AND enabled Scheduler, use acquire instead\n");
     assert(false);
   }
-  return (mutex_ == 0);
+  return (mutex_.load(MEMORY_ORDER_RELAXED) == 0);
 }
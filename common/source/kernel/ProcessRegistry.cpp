@@ -65,7 +65,7 @@ void ProcessRegistry::processExit()
   counter_lock_.acquire();
 
   if (--progs_running_ == 0)
-    all_processes_killed_.signal();
+    all_processes_killed_.broadcast();
 
   counter_lock_.release();
 }
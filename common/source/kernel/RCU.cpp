@@ -0,0 +1,115 @@
+#include "RCU.h"
+#include "Thread.h"
+#include "Scheduler.h"
+#include "kprintf.h"
+#include "assert.h"
+
+RCU* RCU::instance_ = 0;
+
+RCU* RCU::instance()
+{
+  if (unlikely(!instance_))
+    instance_ = new RCU();
+  return instance_;
+}
+
+RCU::RCU() :
+    phase_(0), current_(0), grace_period_phase_(0), next_(0), done_(0), done_grace_periods_(0), lock_("RCU::lock_")
+{
+  readers_[0] = 0;
+  readers_[1] = 0;
+}
+
+void RCU::readLock()
+{
+  if (unlikely(!currentThread))
+    return;
+  // interrupt handlers may read as well, the nesting level and the phase have to be changed together
+  McsNode node;
+  bool interrupts_enabled = lock_.acquireIrqSave(node);
+  if (!currentThread->rcu_read_nesting_++)
+  {
+    currentThread->rcu_phase_ = phase_;
+    ++readers_[phase_];
+  }
+  lock_.releaseIrqRestore(node, interrupts_enabled);
+}
+
+void RCU::readUnlock()
+{
+  if (unlikely(!currentThread))
+    return;
+  McsNode node;
+  bool interrupts_enabled = lock_.acquireIrqSave(node);
+  assert(currentThread->rcu_read_nesting_ > 0);
+  if (!--currentThread->rcu_read_nesting_)
+    --readers_[currentThread->rcu_phase_];
+  lock_.releaseIrqRestore(node, interrupts_enabled);
+}
+
+void RCU::call(RCUHead* head, void (*reclaim)(RCUHead* head))
+{
+  head->reclaim_ = reclaim;
+  McsNode node;
+  bool interrupts_enabled = lock_.acquireIrqSave(node);
+  head->next_ = next_;
+  next_ = head;
+  lock_.releaseIrqRestore(node, interrupts_enabled);
+}
+
+void RCU::startGracePeriod()
+{
+  if (current_ || !next_)
+    return;
+  // the readers of the other phase are gone since the last grace period ended, new readers enter it from now on
+  current_ = next_;
+  next_ = 0;
+  grace_period_phase_ = phase_;
+  phase_ ^= 1;
+}
+
+void RCU::quiescentState()
+{
+  McsNode node;
+  lock_.acquire(node);
+  startGracePeriod();
+  if (!current_ || readers_[grace_period_phase_])
+  {
+    lock_.release(node);
+    return;
+  }
+  RCUHead* last = current_;
+  while (last->next_)
+    last = last->next_;
+  last->next_ = done_;
+  done_ = current_;
+  current_ = 0;
+  ++done_grace_periods_;
+  startGracePeriod();
+  lock_.release(node);
+  Scheduler::instance()->invokeCleanup();
+}
+
+void RCU::reclaim()
+{
+  McsNode node;
+  bool interrupts_enabled = lock_.acquireIrqSave(node);
+  RCUHead* head = done_;
+  size_t grace_periods = done_grace_periods_;
+  done_ = 0;
+  done_grace_periods_ = 0;
+  lock_.releaseIrqRestore(node, interrupts_enabled);
+
+  size_t count = 0;
+  while (head)
+  {
+    RCUHead* next = head->next_;
+    head->reclaim_(head);
+    head = next;
+    ++count;
+  }
+  if (count)
+    debug(SCHEDULER, "RCU::reclaim: %d frees of %d grace periods done\n", count, grace_periods);
+  for (; grace_periods; --grace_periods)
+    currentThread->jobDone();
+}
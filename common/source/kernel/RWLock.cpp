@@ -0,0 +1,99 @@
+#include "RWLock.h"
+#include "kprintf.h"
+#include "assert.h"
+#include "Scheduler.h"
+#include "Thread.h"
+
+RWLock::RWLock(const char* name) :
+  Lock::Lock(name), readers_(0), waiting_writers_(0)
+{
+}
+
+void RWLock::readAcquire(const char* debug_info)
+{
+  if(unlikely(system_state != RUNNING))
+    return;
+  checkCurrentThreadStillWaitingOnAnotherLock(debug_info);
+  lockWaitersList();
+  uint64 wait_start = 0;
+  if(held_by_ || waiting_writers_)
+    wait_start = contentionStart();
+  while(held_by_ || waiting_writers_)
+  {
+    doChecksBeforeWaiting(debug_info);
+    Scheduler::instance()->sleepAndRelease(*(Lock*)this);
+    currentThread->lock_waiting_on_ = 0;
+    lockWaitersList();
+  }
+  ++readers_;
+  // readers share the lock, only the time until they got it is measured
+  recordAcquisition(wait_start, false);
+  unlockWaitersList();
+}
+
+void RWLock::readRelease(const char* debug_info)
+{
+  if(unlikely(system_state != RUNNING))
+    return;
+  lockWaitersList();
+  if(unlikely(readers_ == 0))
+  {
+    debug(LOCK, "RWLock::readRelease: RWLock %s (%p) is not held for reading, currentThread %s (%p)\n",
+          getName(), this, currentThread->getName(), currentThread);
+    if(debug_info) debug(LOCK, "Debug Info: %s\n", debug_info);
+    assert(false);
+  }
+  if(--readers_ == 0)
+    wakeWaiters();
+  unlockWaitersList();
+}
+
+void RWLock::writeAcquire(const char* debug_info)
+{
+  if(unlikely(system_state != RUNNING))
+    return;
+  checkCurrentThreadStillWaitingOnAnotherLock(debug_info);
+  lockWaitersList();
+  uint64 wait_start = 0;
+  if(held_by_ || readers_)
+  {
+    wait_start = contentionStart();
+    ++waiting_writers_;
+    do
+    {
+      doChecksBeforeWaiting(debug_info);
+      Scheduler::instance()->sleepAndRelease(*(Lock*)this);
+      currentThread->lock_waiting_on_ = 0;
+      lockWaitersList();
+    } while(held_by_ || readers_);
+    --waiting_writers_;
+  }
+  held_by_ = currentThread;
+  pushFrontToCurrentThreadHoldingList();
+  recordAcquisition(wait_start);
+  unlockWaitersList();
+}
+
+void RWLock::writeRelease(const char* debug_info)
+{
+  if(unlikely(system_state != RUNNING))
+    return;
+  checkInvalidRelease("RWLock::writeRelease", debug_info);
+  recordRelease();
+  removeFromCurrentThreadHoldingList();
+  lockWaitersList();
+  held_by_ = 0;
+  wakeWaiters();
+  unlockWaitersList();
+}
+
+void RWLock::wakeWaiters()
+{
+  // the waiting writer which gets the lock first keeps the others out,
+  // the waiting readers go back to sleep as long as a writer waits
+  while(Thread* thread = popBackThreadFromWaitersList())
+  {
+    if(thread->state_ == Sleeping)
+      Scheduler::instance()->wake(thread);
+  }
+}
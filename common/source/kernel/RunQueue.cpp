@@ -0,0 +1,186 @@
+#include "RunQueue.h"
+#include "Thread.h"
+#include "assert.h"
+
+/**
+ * weights of the nice values NICE_MIN to NICE_MAX, each step is about 1.25 (as used by linux)
+ */
+static const uint32 nice_to_weight[NICE_MAX - NICE_MIN + 1] =
+{
+  /* -20 */ 88761, 71755, 56483, 46273, 36291,
+  /* -15 */ 29154, 23254, 18705, 14949, 11916,
+  /* -10 */ 9548, 7620, 6100, 4904, 3906,
+  /*  -5 */ 3121, 2501, 1991, 1586, 1277,
+  /*   0 */ 1024, 820, 655, 526, 423,
+  /*   5 */ 335, 272, 215, 172, 137,
+  /*  10 */ 110, 87, 70, 56, 45,
+  /*  15 */ 36, 29, 23, 18, 15
+};
+
+RunQueue::RunQueue() :
+    deadline_heap_(0), occupied_levels_(0), occupied_rt_levels_(0), rt_sequence_(0), count_(0)
+{
+  for (size_t i = 0; i < NUM_PRIORITIES; ++i)
+  {
+    heaps_[i] = 0;
+    min_vruntime_[i] = 0;
+  }
+  for (size_t i = 0; i < NUM_RT_PRIORITIES; ++i)
+    rt_heaps_[i] = 0;
+}
+
+uint32 RunQueue::niceToWeight(int32 nice)
+{
+  assert(nice >= NICE_MIN && nice <= NICE_MAX);
+  return nice_to_weight[nice - NICE_MIN];
+}
+
+Thread* RunQueue::meld(Thread* a, Thread* b)
+{
+  if (!a)
+    return b;
+  if (!b)
+    return a;
+  if (b->run_queue_key_ < a->run_queue_key_)
+  {
+    Thread* tmp = a;
+    a = b;
+    b = tmp;
+  }
+  // b becomes the first child of a
+  b->run_queue_next_ = a->run_queue_child_;
+  if (a->run_queue_child_)
+    a->run_queue_child_->run_queue_prev_ = b;
+  b->run_queue_prev_ = a;
+  a->run_queue_child_ = b;
+  return a;
+}
+
+Thread* RunQueue::mergePairs(Thread* first)
+{
+  // first pass, the melded pairs are collected in reverse order
+  Thread* pairs = 0;
+  while (first)
+  {
+    Thread* a = first;
+    Thread* b = a->run_queue_next_;
+    first = b ? b->run_queue_next_ : 0;
+    a->run_queue_next_ = 0;
+    a->run_queue_prev_ = 0;
+    if (b)
+    {
+      b->run_queue_next_ = 0;
+      b->run_queue_prev_ = 0;
+    }
+    Thread* pair = meld(a, b);
+    pair->run_queue_next_ = pairs;
+    pairs = pair;
+  }
+  // second pass
+  Thread* root = 0;
+  while (pairs)
+  {
+    Thread* next = pairs->run_queue_next_;
+    pairs->run_queue_next_ = 0;
+    root = meld(root, pairs);
+    pairs = next;
+  }
+  return root;
+}
+
+Thread*& RunQueue::heapOf(Thread* thread)
+{
+  if (thread->run_queue_class_ == SCHED_CLASS_DEADLINE)
+    return deadline_heap_;
+  if (thread->run_queue_class_ == SCHED_CLASS_RT)
+    return rt_heaps_[thread->run_queue_level_];
+  return heaps_[thread->run_queue_level_];
+}
+
+void RunQueue::enqueue(Thread* thread)
+{
+  if (thread->on_run_queue_)
+    return;
+  assert(thread->run_queue_level_ < (thread->run_queue_class_ == SCHED_CLASS_RT ? NUM_RT_PRIORITIES
+                                                                                 : NUM_PRIORITIES));
+
+  if (thread->run_queue_class_ == SCHED_CLASS_DEADLINE)
+    thread->run_queue_key_ = thread->dl_deadline_;
+  else if (thread->run_queue_class_ == SCHED_CLASS_RT)
+  {
+    thread->run_queue_key_ = rt_sequence_++;
+    occupied_rt_levels_ |= (1U << thread->run_queue_level_);
+  }
+  else
+  {
+    uint32 level = thread->run_queue_level_;
+    // a thread coming back from sleeping must not get the CPU for all the time it missed
+    if (thread->vruntime_ < min_vruntime_[level])
+      thread->vruntime_ = min_vruntime_[level];
+    thread->run_queue_key_ = thread->vruntime_;
+    occupied_levels_ |= (1U << level);
+  }
+
+  thread->run_queue_child_ = 0;
+  thread->run_queue_next_ = 0;
+  thread->run_queue_prev_ = 0;
+  Thread*& heap = heapOf(thread);
+  heap = meld(heap, thread);
+
+  thread->on_run_queue_ = true;
+  ++count_;
+}
+
+void RunQueue::dequeue(Thread* thread)
+{
+  if (!thread->on_run_queue_)
+    return;
+  Thread*& heap = heapOf(thread);
+
+  if (thread == heap)
+    heap = mergePairs(thread->run_queue_child_);
+  else
+  {
+    // cut the thread's subtree out of its parent's list of children
+    if (thread->run_queue_prev_->run_queue_child_ == thread)
+      thread->run_queue_prev_->run_queue_child_ = thread->run_queue_next_;
+    else
+      thread->run_queue_prev_->run_queue_next_ = thread->run_queue_next_;
+    if (thread->run_queue_next_)
+      thread->run_queue_next_->run_queue_prev_ = thread->run_queue_prev_;
+    heap = meld(heap, mergePairs(thread->run_queue_child_));
+  }
+
+  thread->run_queue_child_ = 0;
+  thread->run_queue_next_ = 0;
+  thread->run_queue_prev_ = 0;
+  thread->on_run_queue_ = false;
+  if (!heap)
+  {
+    if (thread->run_queue_class_ == SCHED_CLASS_RT)
+      occupied_rt_levels_ &= ~(1U << thread->run_queue_level_);
+    else if (thread->run_queue_class_ == SCHED_CLASS_NORMAL)
+      occupied_levels_ &= ~(1U << thread->run_queue_level_);
+  }
+  --count_;
+}
+
+Thread* RunQueue::pickNext(bool normal_first)
+{
+  Thread* thread;
+  // the lowest set bit is the highest non-empty priority level
+  if (normal_first && occupied_levels_)
+    thread = heaps_[__builtin_ctz(occupied_levels_)];
+  else if (deadline_heap_)
+    thread = deadline_heap_;
+  else if (occupied_rt_levels_)
+    thread = rt_heaps_[__builtin_ctz(occupied_rt_levels_)];
+  else if (occupied_levels_)
+    thread = heaps_[__builtin_ctz(occupied_levels_)];
+  else
+    return 0;
+  dequeue(thread);
+  if (thread->run_queue_class_ == SCHED_CLASS_NORMAL && thread->vruntime_ > min_vruntime_[thread->run_queue_level_])
+    min_vruntime_[thread->run_queue_level_] = thread->vruntime_;
+  return thread;
+}
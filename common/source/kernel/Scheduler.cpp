@@ -13,6 +13,19 @@
 #include "umap.h"
 #include "ustring.h"
 #include "Lock.h"
+#include "LockDep.h"
+#include "TimerWheel.h"
+#include "RCU.h"
+
+/**
+ * number of timer ticks used to measure the length of a tick in cycles
+ */
+#define TICK_CALIBRATION_TICKS 32
+
+/**
+ * maximum number of holders a boosted priority is passed on to, protects against cycles in the chain
+ */
+#define PRIORITY_INHERITANCE_MAX_DEPTH 16
 
 ArchThreadInfo *currentThreadInfo;
 Thread *currentThread;
@@ -26,15 +39,32 @@ Scheduler *Scheduler::instance()
   return instance_;
 }
 
-Scheduler::Scheduler()
+Scheduler::Scheduler() :
+    threads_lock_("Scheduler::threads_lock_")
 {
   block_scheduling_ = 0;
   ticks_ = 0;
+  tick_stopped_ = false;
+  tick_latched_ = false;
+  last_tick_cycles_ = 0;
+  cycles_per_tick_ = 0;
+  calibration_start_cycles_ = 0;
+  dl_utilization_ = 0;
+  context_switches_ = 0;
+  yields_ = 0;
+  last_runtime_clock_ = runtimeClock();
+  rt_period_start_ = last_runtime_clock_;
+  rt_runtime_used_ = 0;
+  // create the timer wheel and RCU now, they must not be allocated in the timer interrupt
+  TimerWheel::instance();
+  RCU::instance();
+  setScheduling(&cleanup_thread_, SCHED_CLASS_RT, KERNEL_RT_PRIORITY);
   addNewThread(&cleanup_thread_);
-  addNewThread(&idle_thread_);
+  // the idle thread never goes onto the run queue, it runs whenever the queue is empty
+  threads_.pushBack(&idle_thread_);
 }
 
-uint32 Scheduler::schedule()
+uint32 Scheduler::schedule(bool yielding)
 {
   if (block_scheduling_ != 0)
   {
@@ -42,18 +72,61 @@ uint32 Scheduler::schedule()
     return 0;
   }
 
+  uint64 start_cycles = ArchCommon::getCycleCount();
+  // may end a grace period and give the CleanupThread work, before deciding whom to run
+  RCU::instance()->quiescentState();
+  run_queue_length_.add(run_queue_.size());
   Thread* previousThread = currentThread;
+  accountRuntime(previousThread);
+  bool rt_throttled = realTimeThrottled();
+  bool requeue_previous = previousThread && previousThread != &idle_thread_ && previousThread->schedulable();
+  // a yielding thread lets all other runnable threads go first, even if it consumed less CPU time
+  if (requeue_previous && !yielding)
+    enqueue(previousThread);
+
+  // threads which got killed or went to sleep while being queued are dropped here
   do
   {
-    currentThread = threads_.front();
+    currentThread = run_queue_.pickNext(rt_throttled);
+  } while (currentThread && !currentThread->schedulable());
 
-    ustl::rotate(threads_.begin(), threads_.begin() + 1, threads_.end()); // no new/delete here - important because interrupts are disabled
+  if (requeue_previous && yielding)
+  {
+    enqueue(previousThread);
+    if (!currentThread)
+      currentThread = run_queue_.pickNext(rt_throttled);
+  }
 
-    if ((currentThread == previousThread) && (currentThread->state_ != Running))
-    {
-      debug(SCHEDULER, "Scheduler::schedule: ERROR: currentThread == previousThread! Either no thread is in state Running or you added the same thread more than once.");
-    }
-  } while (!currentThread->schedulable());
+  if (!currentThread)
+    currentThread = &idle_thread_;
+
+  uint64 now = ArchCommon::getCycleCount();
+  if (currentThread != previousThread)
+  {
+    ++context_switches_;
+    ++currentThread->context_switches_;
+    // switched out although it could have gone on running
+    if (requeue_previous && !yielding)
+      ++previousThread->preemptions_;
+  }
+  if (currentThread->wake_cycles_)
+  {
+    currentThread->wakeup_latency_.add(now - currentThread->wake_cycles_);
+    currentThread->wake_cycles_ = 0;
+  }
+  if (currentThread->sleep_cycles_)
+  {
+    lock_sleep_cycles_.add(now - currentThread->sleep_cycles_);
+    currentThread->sleep_cycles_ = 0;
+  }
+  schedule_cycles_.add(now - start_cycles);
+
+  // nobody to preempt to and no timer to expire, no need for timer interrupts
+  // (the PIT is shared, this relies on the kernel running on a single CPU)
+  if (run_queue_.isEmpty() && TimerWheel::instance()->isEmpty())
+    stopTick();
+  else
+    startTick();
 //  debug ( SCHEDULER,"Scheduler::schedule: new currentThread is %x %s, switch_userspace:%d\n",currentThread,currentThread ? currentThread->getName() : 0,currentThread ? currentThread->switch_to_userspace_ : 0);
 
   uint32 ret = 1;
@@ -72,11 +145,10 @@ uint32 Scheduler::schedule()
 void Scheduler::addNewThread(Thread *thread)
 {
   debug(SCHEDULER, "addNewThread: %x  %d:%s\n", thread, thread->getTID(), thread->getName());
-  KernelMemoryManager::instance()->getKMMLock().acquire("in addNewThread");
-  lockScheduling();
-  KernelMemoryManager::instance()->getKMMLock().release("in addNewThread");
-  threads_.push_back(thread);
-  unlockScheduling();
+  threads_lock_.acquire("in addNewThread");
+  threads_.pushBack(thread);
+  threads_lock_.release("in addNewThread");
+  enqueueIfSchedulable(thread);
 }
 
 void Scheduler::invokeCleanup()
@@ -88,12 +160,251 @@ void Scheduler::sleep()
 {
   currentThread->state_ = Sleeping;
   assert(block_scheduling_ == 0);
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  run_queue_.dequeue(currentThread);
+  if (interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
   yield();
 }
 
+void Scheduler::sleepFor(size_t ticks)
+{
+  Timer timeout(ticks);
+  currentThread->state_ = Sleeping;
+  assert(block_scheduling_ == 0);
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  run_queue_.dequeue(currentThread);
+  TimerWheel::instance()->add(&timeout, getTicks());
+  if (interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
+  yield();
+  timeout.cancel();
+}
+
+void Scheduler::sleepWithInterruptsDisabled(Timer *timeout)
+{
+  assert(!ArchInterrupts::testIFSet());
+  assert(block_scheduling_ == 0);
+  if (timeout && timeout->expired())
+    return;
+  currentThread->state_ = Sleeping;
+  run_queue_.dequeue(currentThread);
+  if (timeout)
+    TimerWheel::instance()->add(timeout, getTicks());
+  ArchInterrupts::enableInterrupts();
+  yield();
+  ArchInterrupts::disableInterrupts();
+}
+
 void Scheduler::wake(Thread* thread_to_wake)
 {
+  // the wake up latency is measured until schedule() switches to the thread
+  if (thread_to_wake != currentThread && !thread_to_wake->wake_cycles_)
+    thread_to_wake->wake_cycles_ = ArchCommon::getCycleCount();
   thread_to_wake->state_ = thread_to_wake->isWorker() ? Worker : Running;
+  enqueueIfSchedulable(thread_to_wake);
+}
+
+void Scheduler::enqueueIfSchedulable(Thread *thread)
+{
+  // the currentThread is put back onto the queue by schedule() when it is switched out
+  if (thread == currentThread || thread == &idle_thread_)
+    return;
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  if (thread->schedulable())
+  {
+    enqueue(thread);
+    startTick();
+  }
+  if (interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
+}
+
+bool Scheduler::setScheduling(Thread *thread, SchedulingClass sched_class, uint32 rt_priority, size_t runtime_ticks,
+                              size_t period_ticks)
+{
+  if (sched_class == SCHED_CLASS_RT && rt_priority >= NUM_RT_PRIORITIES)
+    return false;
+  size_t utilization = 0;
+  if (sched_class == SCHED_CLASS_DEADLINE)
+  {
+    if (runtime_ticks == 0 || period_ticks == 0 || runtime_ticks > period_ticks || period_ticks > TIMER_WHEEL_MAX_TIMEOUT)
+      return false;
+    // rounded up, admitting too little is the safe side
+    utilization = (runtime_ticks * 1000 + period_ticks - 1) / period_ticks;
+  }
+
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  size_t released = thread->sched_class_ == SCHED_CLASS_DEADLINE ?
+      (thread->dl_runtime_ticks_ * 1000 + thread->dl_period_ticks_ - 1) / thread->dl_period_ticks_ : 0;
+  bool admitted = dl_utilization_ - released + utilization <= RT_BANDWIDTH_PERMILLE;
+  if (admitted)
+  {
+    dl_utilization_ = dl_utilization_ - released + utilization;
+    bool queued = thread->on_run_queue_;
+    run_queue_.dequeue(thread);
+    thread->sched_class_ = sched_class;
+    thread->rt_priority_ = sched_class == SCHED_CLASS_RT ? rt_priority : 0;
+    thread->dl_runtime_ticks_ = runtime_ticks;
+    thread->dl_period_ticks_ = period_ticks;
+    // the first period starts right away
+    thread->dl_deadline_ = getTicks();
+    thread->dl_budget_ = 0;
+    // the currentThread keeps running in its old class until it is switched out
+    if (queued)
+      enqueue(thread);
+  }
+  if (interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
+
+  debug(SCHEDULER, "setScheduling: %s class %d rt priority %d runtime %d period %d: %s, deadline utilization %d permille\n",
+        thread->getName(), sched_class, rt_priority, runtime_ticks, period_ticks, admitted ? "ok" : "not admitted",
+        dl_utilization_);
+  return admitted;
+}
+
+void Scheduler::enqueue(Thread *thread)
+{
+  if (thread->on_run_queue_)
+    return;
+  thread->run_queue_class_ = thread->sched_class_;
+  if (thread->sched_class_ == SCHED_CLASS_DEADLINE)
+  {
+    size_t now = getTicks();
+    if ((ssize_t) (now - thread->dl_deadline_) >= 0)
+    {
+      // a new period starts, the budget is refilled
+      thread->dl_deadline_ = now + thread->dl_period_ticks_;
+      thread->dl_budget_ = ticksToRuntimeClock(thread->dl_runtime_ticks_);
+    }
+    if (thread->dl_budget_ <= 0)
+      thread->run_queue_class_ = SCHED_CLASS_NORMAL;
+  }
+  thread->run_queue_level_ = thread->run_queue_class_ == SCHED_CLASS_RT ? thread->rt_priority_ :
+                             thread->run_queue_class_ == SCHED_CLASS_NORMAL ? thread->priority_ : 0;
+  if (thread->inherited_rank_ < rankOf(thread))
+  {
+    // a more important thread waits for a mutex held by this thread, it runs on the level of the waiter
+    if (thread->inherited_rank_ <= NUM_RT_PRIORITIES)
+    {
+      thread->run_queue_class_ = SCHED_CLASS_RT;
+      thread->run_queue_level_ = thread->inherited_rank_ ? thread->inherited_rank_ - 1 : 0;
+    }
+    else
+    {
+      thread->run_queue_class_ = SCHED_CLASS_NORMAL;
+      thread->run_queue_level_ = thread->inherited_rank_ - 1 - NUM_RT_PRIORITIES;
+    }
+  }
+  run_queue_.enqueue(thread);
+}
+
+uint32 Scheduler::rankOf(Thread *thread)
+{
+  if (thread->run_queue_class_ == SCHED_CLASS_DEADLINE)
+    return 0;
+  if (thread->run_queue_class_ == SCHED_CLASS_RT)
+    return 1 + thread->run_queue_level_;
+  return 1 + NUM_RT_PRIORITIES + thread->run_queue_level_;
+}
+
+void Scheduler::inheritPriority(Lock *lock)
+{
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  uint32 rank = rankOf(currentThread);
+  // follow the chain as long as the holder waits for another mutex itself
+  for (size_t depth = 0; lock && lock->priority_inheritance_ && depth < PRIORITY_INHERITANCE_MAX_DEPTH; ++depth)
+  {
+    Thread *holder = lock->held_by_;
+    if (!holder || holder == currentThread || holder->inherited_rank_ <= rank)
+      break;
+    debug(SCHEDULER, "inheritPriority: %s (%x) inherits rank %d from %s (%x) via lock %s (%x)\n", holder->getName(),
+          holder, rank, currentThread->getName(), currentThread, lock->getName(), lock);
+    holder->inherited_rank_ = rank;
+    if (holder->on_run_queue_)
+    {
+      run_queue_.dequeue(holder);
+      enqueue(holder);
+    }
+    lock = holder->lock_waiting_on_;
+  }
+  if (interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
+}
+
+void Scheduler::restorePriority()
+{
+  if (currentThread->inherited_rank_ == NO_INHERITED_RANK)
+    return;
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  // the thread keeps the rank of the most important thread still waiting for one of its mutexes
+  uint32 rank = NO_INHERITED_RANK;
+  for (Lock *lock = currentThread->holding_lock_list_; lock; lock = lock->next_lock_on_holding_list_)
+  {
+    if (!lock->priority_inheritance_)
+      continue;
+    for (Thread *waiter = lock->waiters_list_; waiter; waiter = waiter->next_thread_in_lock_waiters_list_)
+    {
+      if (rankOf(waiter) < rank)
+        rank = rankOf(waiter);
+    }
+  }
+  currentThread->inherited_rank_ = rank;
+  // the currentThread is not on the run queue, the rank is applied when it is enqueued the next time
+  if (interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
+}
+
+void Scheduler::setNice(Thread *thread, int32 nice)
+{
+  if (nice < NICE_MIN)
+    nice = NICE_MIN;
+  if (nice > NICE_MAX)
+    nice = NICE_MAX;
+  // the weight is only used when accounting the runtime, the position in the run queue stays valid
+  thread->nice_ = nice;
+}
+
+uint64 Scheduler::runtimeClock()
+{
+  uint64 cycles = ArchCommon::getCycleCount();
+  return cycles ? cycles : (uint64) ticks_ << 20;
+}
+
+void Scheduler::accountRuntime(Thread *thread)
+{
+  uint64 now = runtimeClock();
+  uint64 used = now - last_runtime_clock_;
+  last_runtime_clock_ = now;
+  if (thread && thread != &idle_thread_)
+  {
+    thread->vruntime_ += used * NICE_0_WEIGHT / RunQueue::niceToWeight(thread->nice_);
+    if (thread->run_queue_class_ != SCHED_CLASS_NORMAL)
+      rt_runtime_used_ += used;
+    if (thread->run_queue_class_ == SCHED_CLASS_DEADLINE)
+      thread->dl_budget_ -= used;
+  }
+}
+
+uint64 Scheduler::ticksToRuntimeClock(size_t ticks)
+{
+  if (cycles_per_tick_)
+    return ticks * cycles_per_tick_;
+  // see runtimeClock(), with a cycle counter the length of a tick is not known before the calibration
+  return ArchCommon::getCycleCount() ? 0 : (uint64) ticks << 20;
+}
+
+bool Scheduler::realTimeThrottled()
+{
+  uint64 period = ticksToRuntimeClock(RT_PERIOD_TICKS);
+  if (!period)
+    return false;
+  if (last_runtime_clock_ - rt_period_start_ >= period)
+  {
+    rt_period_start_ = last_runtime_clock_;
+    rt_runtime_used_ = 0;
+  }
+  return rt_runtime_used_ >= period * RT_BANDWIDTH_PERMILLE / 1000;
 }
 
 void Scheduler::yield()
@@ -106,50 +417,48 @@ void Scheduler::yield()
              currentThread, currentThread->name_.c_str());
     currentThread->printBacktrace();
   }
+  ++yields_;
   ArchThreads::yield();
 }
 
 void Scheduler::cleanupDeadThreads()
 {
-  lockScheduling();
-  uint32 thread_count_max = threads_.size();
-  if (thread_count_max > 1024)
-    thread_count_max = 1024;
-  Thread* destroy_list[thread_count_max];
-  uint32 thread_count = 0;
-  for (uint32 i = 0; i < threads_.size(); ++i)
+  MutexLock lock(threads_lock_);
+  // the removed threads are deleted after a grace period, the debug prints may still see them
+  RCUReadLock rl;
+  size_t thread_count = 0;
+  for (Thread* thread : threads_.read())
   {
-    Thread* tmp = threads_[i];
-    if (tmp->state_ == ToBeDestroyed)
-    {
-      destroy_list[thread_count++] = tmp;
-      threads_.erase(threads_.begin() + i); // Note: erase will not realloc!
-      --i;
-    }
-    if (thread_count >= thread_count_max)
-      break;
+    if (thread->state_ != ToBeDestroyed)
+      continue;
+    bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+    run_queue_.dequeue(thread);
+    if (interrupts_enabled)
+      ArchInterrupts::enableInterrupts();
+    if (thread->sched_class_ == SCHED_CLASS_DEADLINE)
+      setScheduling(thread, SCHED_CLASS_NORMAL);
+    threads_.remove(thread);
+    RCU::instance()->deferDelete(thread);
+    cleanup_thread_.jobDone();
+    ++thread_count;
   }
-  unlockScheduling();
   if (thread_count > 0)
-  {
-    for (uint32 i = 0; i < thread_count; ++i)
-    {
-      delete destroy_list[i];
-      cleanup_thread_.jobDone();
-    }
     debug(SCHEDULER, "cleanupDeadThreads: done\n");
-  }
 }
 
 void Scheduler::printThreadList()
 {
   uint32 c = 0;
-  lockScheduling();
+  RCUReadLock rl;
   debug(SCHEDULER, "Scheduler::printThreadList: %d Threads in List\n", threads_.size());
-  for (c = 0; c < threads_.size(); ++c)
-    debug(SCHEDULER, "Scheduler::printThreadList: threads_[%d]: %x  %d:%s     [%s]\n", c, threads_[c],
-          threads_[c]->getTID(), threads_[c]->getName(), Thread::threadStatePrintable[threads_[c]->state_]);
-  unlockScheduling();
+  debug(SCHEDULER, "Scheduler::printThreadList: %d threads queued\n", run_queue_.size());
+  for (Thread* thread : threads_.read())
+    debug(SCHEDULER, "Scheduler::printThreadList: threads_[%d]: %x  %d:%s     [%s] %s prio %d nice %d%s\n", c++,
+          thread, thread->getTID(), thread->getName(), Thread::threadStatePrintable[thread->state_],
+          thread->sched_class_ == SCHED_CLASS_DEADLINE ? "deadline" :
+          thread->sched_class_ == SCHED_CLASS_RT ? "rt" : "normal",
+          thread->sched_class_ == SCHED_CLASS_RT ? thread->rt_priority_ : thread->priority_,
+          thread->nice_, thread->on_run_queue_ ? " (queued)" : "");
 }
 
 void Scheduler::lockScheduling() //not as severe as stopping Interrupts
@@ -163,6 +472,11 @@ void Scheduler::unlockScheduling()
   block_scheduling_ = 0;
 }
 
+bool Scheduler::isRunning(Thread *thread)
+{
+  return thread == currentThread;
+}
+
 bool Scheduler::isSchedulingEnabled()
 {
   if (this)
@@ -173,27 +487,73 @@ bool Scheduler::isSchedulingEnabled()
 
 uint32 Scheduler::getTicks()
 {
-  return ticks_;
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  size_t ticks = ticks_;
+  if (tick_stopped_)
+    ticks += (ArchCommon::getCycleCount() - last_tick_cycles_) / cycles_per_tick_;
+  if (interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
+  return ticks;
 }
 
 void Scheduler::incTicks()
 {
+  uint64 now = ArchCommon::getCycleCount();
+  if (tick_latched_)
+  {
+    tick_latched_ = false;
+    // delivered right after startTick(), its tick was already accounted for there
+    if (now - last_tick_cycles_ < cycles_per_tick_)
+      return;
+  }
   ++ticks_;
+  last_tick_cycles_ = now;
+  TimerWheel::instance()->advance(ticks_);
+
+  if (!cycles_per_tick_ && now)
+  {
+    if (!calibration_start_cycles_)
+      calibration_start_cycles_ = now;
+    else if (ticks_ > TICK_CALIBRATION_TICKS)
+    {
+      cycles_per_tick_ = (now - calibration_start_cycles_) / (ticks_ - 1);
+      debug(SCHEDULER, "incTicks: a tick takes %d cycles, dynamic tick enabled\n", (size_t) cycles_per_tick_);
+    }
+  }
+}
+
+void Scheduler::startTick()
+{
+  if (!tick_stopped_)
+    return;
+  uint64 passed_ticks = (ArchCommon::getCycleCount() - last_tick_cycles_) / cycles_per_tick_;
+  ticks_ += passed_ticks;
+  last_tick_cycles_ += passed_ticks * cycles_per_tick_;
+  // the PIC keeps one timer interrupt pending if the timer fired while it was masked
+  tick_latched_ = passed_ticks > 0;
+  tick_stopped_ = false;
+  ArchInterrupts::enableTimer();
+}
+
+void Scheduler::stopTick()
+{
+  if (tick_stopped_ || !cycles_per_tick_)
+    return;
+  tick_stopped_ = true;
+  ArchInterrupts::disableTimer();
 }
 
 void Scheduler::printStackTraces()
 {
-  lockScheduling();
+  RCUReadLock rl;
   debug(BACKTRACE, "printing the backtraces of <%d> threads:\n", threads_.size());
 
-  for (ustl::list<Thread*>::iterator it = threads_.begin(); it != threads_.end(); ++it)
+  for (Thread* thread : threads_.read())
   {
-    (*it)->printBacktrace();
+    thread->printBacktrace();
     debug(BACKTRACE, "\n");
     debug(BACKTRACE, "\n");
   }
-
-  unlockScheduling();
 }
 
 static void printUserSpaceTracesHelper()
@@ -205,22 +565,18 @@ static void printUserSpaceTracesHelper()
 
 void Scheduler::printLockingInformation()
 {
-  size_t thread_count;
-  Thread* thread;
-  lockScheduling();
+  RCUReadLock rl;
   kprintfd("\n");
   debug(LOCK, "Scheduler::printLockingInformation:\n");
-  for (thread_count = 0; thread_count < threads_.size(); ++thread_count)
+  for (Thread* thread : threads_.read())
   {
-    thread = threads_[thread_count];
     if(thread->holding_lock_list_ != 0)
     {
-      Lock::printHoldingList(threads_[thread_count]);
+      Lock::printHoldingList(thread);
     }
   }
-  for (thread_count = 0; thread_count < threads_.size(); ++thread_count)
+  for (Thread* thread : threads_.read())
   {
-    thread = threads_[thread_count];
     if(thread->lock_waiting_on_ != 0)
     {
       debug(LOCK, "Thread %s (0x%x) is waiting on lock: %s (0x%x).\n", thread->getName(), thread,
@@ -228,6 +584,26 @@ void Scheduler::printLockingInformation()
     }
   }
   debug(LOCK, "Scheduler::printLockingInformation finished\n");
+  LockDep::printStatistics();
+  Lock::printContentionStatistics();
+}
+
+void Scheduler::printSchedulingStatistics()
+{
+  lockScheduling();
+  debug(SCHEDULER, "Scheduler::printSchedulingStatistics: %d context switches, %d yields, latencies in cycles\n",
+        (size_t) context_switches_, (size_t) yields_);
+  schedule_cycles_.print("schedule()", "cycles");
+  run_queue_length_.print("run queue length", "threads");
+  lock_sleep_cycles_.print("sleeping on locks", "cycles");
+  RCUReadLock rl;
+  for (Thread *t : threads_.read())
+  {
+    kprintfd("%d:%s: %d context switches, %d preemptions\n", t->getTID(), t->getName(), t->context_switches_,
+             t->preemptions_);
+    if (t->wakeup_latency_.getCount())
+      t->wakeup_latency_.print("wake up latency", "cycles");
+  }
   unlockScheduling();
 }
 
@@ -235,9 +611,9 @@ void Scheduler::printUserSpaceTraces()
 {
   lockScheduling();
   debug(USERTRACE, "Scheduling all userspace threads to print a stacktrace\n");
-  for (ustl::list<Thread*>::iterator it = threads_.begin(); it != threads_.end(); ++it)
+  RCUReadLock rl;
+  for (Thread *t : threads_.read())
   {
-    Thread *t = *it;
     if (t->user_arch_thread_info_)
     {
       if (t->switch_to_userspace_)
@@ -256,7 +632,7 @@ void Scheduler::printUserSpaceTraces()
   unlockScheduling();
 }
 
-void Scheduler::sleepAndRelease(Lock &lock)
+void Scheduler::sleepAndRelease(Lock &lock, Timer *timeout)
 {
   assert(lock.waitersListIsLocked());
   // push back the current thread onto the waiters list
@@ -264,7 +640,20 @@ void Scheduler::sleepAndRelease(Lock &lock)
   lock.pushFrontCurrentThreadToWaitersList();
 
   lockScheduling();
+  currentThread->sleep_cycles_ = ArchCommon::getCycleCount();
   currentThread->state_ = Sleeping;
+  currentThread->sleep_timer_ = timeout;
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  if (timeout && timeout->expired())
+    currentThread->state_ = Running;
+  else
+  {
+    run_queue_.dequeue(currentThread);
+    if (timeout)
+      TimerWheel::instance()->add(timeout, getTicks());
+  }
+  if (interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
   lock.unlockWaitersList();
   unlockScheduling();
   yield();
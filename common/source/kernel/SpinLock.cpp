@@ -20,7 +20,7 @@ bool SpinLock::acquireNonBlocking(const char* debug_info)
   // So in case you see this comment, re-think your implementation and don't just comment out this line!
   doChecksBeforeWaiting(debug_info);
 
-  if(ArchThreads::testSetLock(lock_, 1))
+  if(lock_.exchange(1, MEMORY_ORDER_ACQUIRE))
   {
     // The spinlock is held by another thread at the moment
     return false;
@@ -29,6 +29,7 @@ bool SpinLock::acquireNonBlocking(const char* debug_info)
   assert(held_by_ == 0);
   held_by_ = currentThread;
   pushFrontToCurrentThreadHoldingList();
+  recordAcquisition(0);
   return true;
 }
 
@@ -38,8 +39,10 @@ void SpinLock::acquire(const char* debug_info)
     return;
   //  debug(LOCK, "Spinlock::acquire: Acquire spinlock %s (%p) with thread %s (%p)\n",
   //        getName(), this, currentThread->getName(), currentThread);
-  if(ArchThreads::testSetLock(lock_, 1))
+  uint64 wait_start = 0;
+  if(lock_.exchange(1, MEMORY_ORDER_ACQUIRE))
   {
+    wait_start = contentionStart();
     // We did not directly managed to acquire the spinlock, need to check for deadlocks and
     // to push the current thread to the waiters list.
     doChecksBeforeWaiting(debug_info);
@@ -50,7 +53,7 @@ void SpinLock::acquire(const char* debug_info)
     unlockWaitersList();
 
     // here comes the basic spinlock
-    while(ArchThreads::testSetLock(lock_, 1))
+    while(lock_.exchange(1, MEMORY_ORDER_ACQUIRE))
     {
       //SpinLock: Simplest of Locks, do the next best thing to busy waiting
       Scheduler::instance()->yield();
@@ -64,6 +67,7 @@ void SpinLock::acquire(const char* debug_info)
   // The current thread is now holding the spinlock
   held_by_ = currentThread;
   pushFrontToCurrentThreadHoldingList();
+  recordAcquisition(wait_start);
 }
 
 bool SpinLock::isFree()
@@ -73,7 +77,7 @@ bool SpinLock::isFree()
     debug(LOCK, "SpinLock::isFree: ERROR: Should not be used with IF=1 AND enabled Scheduler, use acquire instead\n");
     assert(false);
   }
-  return (lock_ == 0);
+  return (lock_.load(MEMORY_ORDER_RELAXED) == 0);
 }
 
 void SpinLock::release(const char* debug_info)
@@ -83,8 +87,9 @@ void SpinLock::release(const char* debug_info)
   //debug(LOCK, "Spinlock::release: Release spinlock %s (%p) with thread %s (%p)\n",
   //      getName(), this, currentThread->getName(), currentThread);
   checkInvalidRelease("SpinLock::release", debug_info);
+  recordRelease();
   removeFromCurrentThreadHoldingList();
   held_by_ = 0;
-  lock_ = 0;
+  lock_.store(0, MEMORY_ORDER_RELEASE);
 }
 
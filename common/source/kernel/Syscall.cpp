@@ -11,12 +11,24 @@
 #include "UserProcess.h"
 #include "ProcessRegistry.h"
 #include "File.h"
+#include "TimerWheel.h"
+#include "Futex.h"
+
+/**
+ * the layout of struct timespec in userspace
+ */
+struct UserTimespec
+{
+  ssize_t tv_sec;
+  ssize_t tv_nsec;
+};
 
 size_t Syscall::syscallException(size_t syscall_number, size_t arg1, size_t arg2, size_t arg3, size_t arg4, size_t arg5)
 {
   size_t return_value = 0;
 
-  if (syscall_number != sc_sched_yield || syscall_number == sc_outline) // no debug print because these might occur very often
+  if (syscall_number != sc_sched_yield && syscall_number != sc_outline && syscall_number != sc_nice &&
+      syscall_number != sc_futex) // no debug print because these might occur very often
     debug(SYSCALL, "Syscall %d called with arguments %d(=%x) %d(=%x) %d(=%x) %d(=%x) %d(=%x)\n", syscall_number, arg1,
           arg1, arg2, arg2, arg3, arg3, arg4, arg4, arg5, arg5);
 
@@ -49,6 +61,18 @@ size_t Syscall::syscallException(size_t syscall_number, size_t arg1, size_t arg2
     case sc_trace:
       trace();
       break;
+    case sc_nanosleep:
+      return_value = nanosleep(arg1, arg2);
+      break;
+    case sc_nice:
+      return_value = nice(arg1);
+      break;
+    case sc_sched_setscheduler:
+      return_value = sched_setscheduler(arg1, arg2, arg3, arg4);
+      break;
+    case sc_futex:
+      return_value = futex(arg1, arg2, arg3);
+      break;
     case sc_pseudols:
       VfsSyscall::readdir((const char*) arg1);
       break;
@@ -161,6 +185,91 @@ size_t Syscall::createprocess(size_t path, size_t sleep)
   return 0;
 }
 
+size_t Syscall::nanosleep(size_t request, size_t remaining)
+{
+  if ((request >= 2U * 1024U * 1024U * 1024U) || (remaining >= 2U * 1024U * 1024U * 1024U))
+  {
+    return -1U;
+  }
+  UserTimespec* req = (UserTimespec*) request;
+  if (!req || req->tv_sec < 0 || req->tv_nsec < 0 || req->tv_nsec >= 1000000000)
+  {
+    return -1U;
+  }
+  // the timer frequency is given in mHz, round up to whole ticks
+  uint64 frequency = ArchInterrupts::getTimerFrequency();
+  uint64 ticks = ((uint64) req->tv_sec * frequency + ((uint64) req->tv_nsec * frequency + 999999999) / 1000000000
+      + 999) / 1000;
+  debug(SYSCALL, "Syscall::nanosleep: %d s %d ns = %d ticks\n", req->tv_sec, req->tv_nsec, (size_t) ticks);
+  if (ticks > TIMER_WHEEL_MAX_TIMEOUT)
+    ticks = TIMER_WHEEL_MAX_TIMEOUT;
+  Scheduler::instance()->sleepFor(ticks);
+  if (remaining)
+  {
+    ((UserTimespec*) remaining)->tv_sec = 0;
+    ((UserTimespec*) remaining)->tv_nsec = 0;
+  }
+  return 0;
+}
+
+size_t Syscall::nice(ssize_t increment)
+{
+  // cut the increment first, the sum might overflow otherwise
+  if (increment < NICE_MIN - NICE_MAX)
+    increment = NICE_MIN - NICE_MAX;
+  if (increment > NICE_MAX - NICE_MIN)
+    increment = NICE_MAX - NICE_MIN;
+  Scheduler::instance()->setNice(currentThread, currentThread->getNice() + increment);
+  debug(SYSCALL, "Syscall::nice: nice value of %s is now %d\n", currentThread->getName(), currentThread->getNice());
+  return currentThread->getNice();
+}
+
+size_t Syscall::sched_setscheduler(size_t policy, size_t priority, size_t runtime_ms, size_t period_ms)
+{
+  bool admitted = false;
+  switch (policy)
+  {
+    case SCHED_OTHER:
+      admitted = Scheduler::instance()->setScheduling(currentThread, SCHED_CLASS_NORMAL);
+      break;
+    case SCHED_FIFO:
+    case SCHED_RR:
+      // posix priorities count upwards, the highest real-time level is reserved for kernel workers
+      if (priority < 1 || priority >= NUM_RT_PRIORITIES)
+        return -1U;
+      admitted = Scheduler::instance()->setScheduling(currentThread, SCHED_CLASS_RT, NUM_RT_PRIORITIES - priority);
+      break;
+    case SCHED_DEADLINE:
+    {
+      if (runtime_ms >= 1000000 || period_ms >= 1000000)
+        return -1U;
+      // the timer frequency is given in mHz, round up to whole ticks
+      uint64 frequency = ArchInterrupts::getTimerFrequency();
+      size_t runtime_ticks = (runtime_ms * frequency + 999999) / 1000000;
+      size_t period_ticks = (period_ms * frequency + 999999) / 1000000;
+      admitted = Scheduler::instance()->setScheduling(currentThread, SCHED_CLASS_DEADLINE, 0, runtime_ticks,
+                                                      period_ticks);
+      break;
+    }
+    default:
+      return -1U;
+  }
+  return admitted ? 0 : -1U;
+}
+
+size_t Syscall::futex(size_t address, size_t op, size_t value)
+{
+  switch (op)
+  {
+    case FUTEX_WAIT:
+      return Futex::instance()->wait(address, value);
+    case FUTEX_WAKE:
+      return Futex::instance()->wake(address, value);
+    default:
+      return -1U;
+  }
+}
+
 void Syscall::trace()
 {
   currentThread->printUserBacktrace();
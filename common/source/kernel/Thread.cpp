@@ -10,6 +10,7 @@
 #include "backtrace.h"
 #include "KernelMemoryManager.h"
 #include "Stabs2DebugInfo.h"
+#include "RunQueue.h"
 
 #define MAX_STACK_FRAMES 20
 
@@ -29,7 +30,12 @@ static void ThreadStartHack()
 
 Thread::Thread(FileSystemInfo *working_dir, const char *name) :
     kernel_arch_thread_info_(0), user_arch_thread_info_(0), switch_to_userspace_(0), loader_(0), state_(Running),
-    next_thread_in_lock_waiters_list_(0), lock_waiting_on_(0), holding_lock_list_(0), tid_(0),
+    next_thread_in_lock_waiters_list_(0), lock_waiting_on_(0), holding_lock_list_(0), sleep_timer_(0), tid_(0),
+    priority_(DEFAULT_PRIORITY), run_queue_child_(0), run_queue_next_(0), run_queue_prev_(0), on_run_queue_(false),
+    wait_queue_(0), next_thread_in_wait_queue_(0), rcu_read_nesting_(0), rcu_phase_(0), vruntime_(0), nice_(0),
+    sched_class_(SCHED_CLASS_NORMAL), rt_priority_(0), dl_runtime_ticks_(0), dl_period_ticks_(0), dl_deadline_(0), dl_budget_(0), run_queue_class_(SCHED_CLASS_NORMAL),
+    run_queue_level_(DEFAULT_PRIORITY), inherited_rank_(NO_INHERITED_RANK), run_queue_key_(0), wake_cycles_(0),
+    sleep_cycles_(0), context_switches_(0), preemptions_(0),
     my_terminal_(0), working_dir_(working_dir), name_(name)
 {
   debug(THREAD, "Thread ctor, this is %x, stack is %x\n", this, stack_);
@@ -45,10 +51,8 @@ Thread::~Thread()
   delete loader_;
   loader_ = 0;
   debug(THREAD, "~Thread: freeing ThreadInfos\n");
-  delete user_arch_thread_info_;
-  user_arch_thread_info_ = 0;
-  delete kernel_arch_thread_info_;
-  kernel_arch_thread_info_ = 0;
+  ArchThreads::cleanupThreadInfos(user_arch_thread_info_);
+  ArchThreads::cleanupThreadInfos(kernel_arch_thread_info_);
   delete working_dir_;
   working_dir_ = 0;
   debug(THREAD, "~Thread: done (%s)\n", name_.c_str());
@@ -190,19 +194,14 @@ void Thread::printUserBacktrace()
 
 void Thread::addJob()
 {
-  if(!ArchInterrupts::testIFSet())
-  {
-    jobs_scheduled_++;
-  }
-  else
-  {
-    ArchThreads::atomic_add(jobs_scheduled_, 1);
-  }
+  jobs_scheduled_.fetchAdd(1, MEMORY_ORDER_RELEASE);
+  // a worker without work is not on the run queue, put it back there
+  Scheduler::instance()->enqueueIfSchedulable(this);
 }
 
 void Thread::jobDone()
 {
-  ArchThreads::atomic_add(jobs_done_, 1);
+  jobs_done_.fetchAdd(1, MEMORY_ORDER_RELEASE);
 }
 
 void Thread::waitForNextJob()
@@ -213,14 +212,14 @@ void Thread::waitForNextJob()
 
 bool Thread::hasWork()
 {
-  return jobs_done_ < jobs_scheduled_;
+  return jobs_done_.load(MEMORY_ORDER_ACQUIRE) < jobs_scheduled_.load(MEMORY_ORDER_ACQUIRE);
 }
 
 bool Thread::isWorker() const
 {
   // If it is a worker thread, the thread state may be sleeping.
   // But in this case, the thread has at least one job scheduled.
-  return (state_ == Worker) || (jobs_scheduled_ > 0);
+  return (state_ == Worker) || (jobs_scheduled_.load(MEMORY_ORDER_RELAXED) > 0);
 }
 
 bool Thread::schedulable()
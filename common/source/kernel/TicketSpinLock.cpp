@@ -0,0 +1,70 @@
+#include "TicketSpinLock.h"
+#include "ArchThreads.h"
+#include "ArchInterrupts.h"
+#include "Scheduler.h"
+#include "Thread.h"
+#include "kprintf.h"
+#include "assert.h"
+
+TicketSpinLock::TicketSpinLock(const char* name) :
+    name_(name), next_ticket_(0), now_serving_(0), held_by_(0)
+{
+}
+
+void TicketSpinLock::acquire()
+{
+  if (unlikely(currentThread && held_by_ == currentThread))
+  {
+    debug(LOCK, "TicketSpinLock::acquire: ERROR: %s (%p) is already held by thread %s (%p), "
+          "maybe it is shared with an interrupt handler but not taken with acquireIrqSave\n",
+          name_, this, currentThread->getName(), currentThread);
+    assert(false);
+  }
+  size_t ticket = next_ticket_.fetchAdd(1, MEMORY_ORDER_RELAXED);
+  size_t spins = 0;
+  while (now_serving_.load(MEMORY_ORDER_ACQUIRE) != ticket)
+  {
+    ArchThreads::spinLoopHint();
+    if (++spins >= SPINLOCK_YIELD_ITERATIONS && system_state == RUNNING && ArchInterrupts::testIFSet())
+    {
+      Scheduler::instance()->yield();
+      spins = 0;
+    }
+  }
+  held_by_ = currentThread;
+}
+
+bool TicketSpinLock::acquireNonBlocking()
+{
+  size_t serving = now_serving_.load(MEMORY_ORDER_RELAXED);
+  if (!next_ticket_.compareExchange(serving, serving + 1, MEMORY_ORDER_ACQUIRE))
+    return false;
+  held_by_ = currentThread;
+  return true;
+}
+
+void TicketSpinLock::release()
+{
+  held_by_ = 0;
+  // only the holder writes now_serving_, the store makes the critical section visible to the next one
+  now_serving_.store(now_serving_.load(MEMORY_ORDER_RELAXED) + 1, MEMORY_ORDER_RELEASE);
+}
+
+bool TicketSpinLock::acquireIrqSave()
+{
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  acquire();
+  return interrupts_enabled;
+}
+
+void TicketSpinLock::releaseIrqRestore(bool interrupts_enabled)
+{
+  release();
+  if (interrupts_enabled)
+    ArchInterrupts::enableInterrupts();
+}
+
+bool TicketSpinLock::isFree()
+{
+  return now_serving_.load(MEMORY_ORDER_RELAXED) == next_ticket_.load(MEMORY_ORDER_RELAXED);
+}
@@ -0,0 +1,147 @@
+#include "TimerWheel.h"
+#include "Thread.h"
+#include "Scheduler.h"
+#include "ArchInterrupts.h"
+#include "assert.h"
+
+Timer::Timer(size_t timeout_ticks) :
+    thread_(currentThread), timeout_ticks_(timeout_ticks), expires_(0), next_(0), prev_(0), slot_(0),
+    expired_(false)
+{
+  if (timeout_ticks_ > TIMER_WHEEL_MAX_TIMEOUT)
+    timeout_ticks_ = TIMER_WHEEL_MAX_TIMEOUT;
+}
+
+Timer::~Timer()
+{
+  cancel();
+}
+
+void Timer::cancel()
+{
+  TimerWheel::instance()->cancel(this);
+}
+
+TimerWheel* TimerWheel::instance_ = 0;
+
+TimerWheel* TimerWheel::instance()
+{
+  if (unlikely(!instance_))
+    instance_ = new TimerWheel();
+  return instance_;
+}
+
+TimerWheel::TimerWheel() :
+    current_(0), count_(0), lock_("TimerWheel::lock_")
+{
+  for (size_t level = 0; level < TIMER_WHEEL_LEVELS; ++level)
+    for (size_t slot = 0; slot < TIMER_WHEEL_SLOTS; ++slot)
+      slots_[level][slot] = 0;
+}
+
+void TimerWheel::add(Timer* timer, size_t now)
+{
+  bool interrupts_enabled = lock_.acquireIrqSave();
+  if (!timer->slot_ && !timer->expired_)
+  {
+    // while the wheel is empty nobody advances it (the tick may even be stopped)
+    if (count_ == 0)
+      current_ = now;
+    timer->expires_ = current_ + timer->timeout_ticks_;
+    insert(timer);
+    ++count_;
+  }
+  lock_.releaseIrqRestore(interrupts_enabled);
+}
+
+void TimerWheel::cancel(Timer* timer)
+{
+  bool interrupts_enabled = lock_.acquireIrqSave();
+  if (timer->slot_)
+  {
+    unlink(timer);
+    --count_;
+  }
+  lock_.releaseIrqRestore(interrupts_enabled);
+}
+
+void TimerWheel::insert(Timer* timer)
+{
+  size_t delta = timer->expires_ - current_;
+  size_t level = 0;
+  // timers which are already due go into the current slot of level 0
+  if ((ssize_t) delta < 0)
+    timer->expires_ = current_;
+  else
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1UL << ((level + 1) * TIMER_WHEEL_SLOT_BITS)))
+      ++level;
+  size_t index = (timer->expires_ >> (level * TIMER_WHEEL_SLOT_BITS)) & (TIMER_WHEEL_SLOTS - 1);
+
+  Timer** slot = &slots_[level][index];
+  timer->prev_ = 0;
+  timer->next_ = *slot;
+  if (*slot)
+    (*slot)->prev_ = timer;
+  *slot = timer;
+  timer->slot_ = slot;
+}
+
+void TimerWheel::unlink(Timer* timer)
+{
+  if (timer->prev_)
+    timer->prev_->next_ = timer->next_;
+  else
+    *timer->slot_ = timer->next_;
+  if (timer->next_)
+    timer->next_->prev_ = timer->prev_;
+  timer->next_ = 0;
+  timer->prev_ = 0;
+  timer->slot_ = 0;
+}
+
+size_t TimerWheel::cascade(size_t level)
+{
+  size_t index = (current_ >> (level * TIMER_WHEEL_SLOT_BITS)) & (TIMER_WHEEL_SLOTS - 1);
+  Timer* timer = slots_[level][index];
+  slots_[level][index] = 0;
+  while (timer)
+  {
+    Timer* next = timer->next_;
+    insert(timer);
+    timer = next;
+  }
+  return index;
+}
+
+void TimerWheel::expire(Timer* timer)
+{
+  unlink(timer);
+  --count_;
+  timer->expired_ = true;
+  // the thread may already have been woken up by someone else (e.g. a signalled Condition)
+  if (timer->thread_->state_ == Sleeping)
+    Scheduler::instance()->wake(timer->thread_);
+}
+
+void TimerWheel::advance(size_t now)
+{
+  assert(!ArchInterrupts::testIFSet());
+  lock_.acquire();
+  if (count_ == 0)
+  {
+    current_ = now + 1;
+    lock_.release();
+    return;
+  }
+  while ((ssize_t) (now - current_) >= 0)
+  {
+    size_t index = current_ & (TIMER_WHEEL_SLOTS - 1);
+    for (size_t level = 1; !index && level < TIMER_WHEEL_LEVELS; ++level)
+      index = cascade(level);
+    index = current_ & (TIMER_WHEEL_SLOTS - 1);
+    while (slots_[0][index])
+      expire(slots_[0][index]);
+    ++current_;
+  }
+  lock_.release();
+}
@@ -5,6 +5,19 @@
 #include "Loader.h"
 #include "VfsSyscall.h"
 #include "File.h"
+#include "SlabAllocator.h"
+
+static SlabCache* process_cache;
+
+void* UserProcess::operator new(size_t size)
+{
+  return SlabAllocator::instance()->getCache(process_cache, "UserProcess", sizeof(UserProcess))->allocate(size);
+}
+
+void UserProcess::operator delete(void* address, size_t size)
+{
+  process_cache->free(address, size);
+}
 
 UserProcess::UserProcess(const char *minixfs_filename, FileSystemInfo *fs_info, ProcessRegistry *process_registry,
                          uint32 terminal_number) :
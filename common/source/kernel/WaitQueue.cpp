@@ -0,0 +1,159 @@
+#include "WaitQueue.h"
+#include "Thread.h"
+#include "Mutex.h"
+#include "Scheduler.h"
+#include "ArchInterrupts.h"
+#include "TimerWheel.h"
+#include "kprintf.h"
+#include "assert.h"
+
+WaitQueue::WaitQueue(const char* name) :
+    name_(name ? name : ""), lock_("WaitQueue::lock_"), head_(0), tail_(0)
+{
+}
+
+WaitQueue::~WaitQueue()
+{
+  if (unlikely(system_state != RUNNING))
+    return;
+  Thread* waiter = head_;
+  if (waiter)
+  {
+    debug(LOCK, "ERROR: WaitQueue::~WaitQueue %s (%x): At least thread %s (%x) is still waiting on it, "
+          "currentThread is: %x\n", name_, this, waiter->getName(), waiter, currentThread);
+    assert(false);
+  }
+}
+
+void WaitQueue::wait(Mutex* mutex)
+{
+  doWait(0, mutex);
+}
+
+bool WaitQueue::waitWithTimeout(size_t timeout_ticks, Mutex* mutex)
+{
+  Timer timeout(timeout_ticks);
+  return doWait(&timeout, mutex);
+}
+
+bool WaitQueue::doWait(Timer* timeout, Mutex* mutex)
+{
+  if (unlikely(system_state != RUNNING || !currentThread))
+  {
+    // nobody to switch to yet, just give pending interrupts a chance, the caller polls its condition
+    if (mutex)
+      mutex->release();
+    bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+    ArchInterrupts::enableInterrupts();
+    if (!interrupts_enabled)
+      ArchInterrupts::disableInterrupts();
+    return true;
+  }
+
+  bool interrupts_enabled = ArchInterrupts::disableInterrupts();
+  lock_.acquire();
+  append(currentThread);
+  lock_.release();
+  if (mutex)
+  {
+    // the thread is on the queue already, a wake up after releasing the mutex is not lost
+    ArchInterrupts::enableInterrupts();
+    mutex->release();
+    ArchInterrupts::disableInterrupts();
+  }
+  // in case the thread has been woken up meanwhile it is not on the queue any longer
+  if (currentThread->wait_queue_ == this)
+    Scheduler::instance()->sleepWithInterruptsDisabled(timeout);
+
+  lock_.acquire();
+  bool woken_up = (currentThread->wait_queue_ != this);
+  if (!woken_up)
+    remove(currentThread);
+  lock_.releaseIrqRestore(interrupts_enabled);
+  if (timeout)
+    timeout->cancel();
+  return woken_up;
+}
+
+bool WaitQueue::wakeOne()
+{
+  bool interrupts_enabled = lock_.acquireIrqSave();
+  Thread* thread = popFront();
+  if (thread)
+    wake(thread);
+  lock_.releaseIrqRestore(interrupts_enabled);
+  return thread != 0;
+}
+
+size_t WaitQueue::wakeAll()
+{
+  size_t count = 0;
+  bool interrupts_enabled = lock_.acquireIrqSave();
+  // take the whole list at once, the threads are woken up in the order they started waiting
+  Thread* thread = head_;
+  head_ = 0;
+  tail_ = 0;
+  while (thread)
+  {
+    Thread* next = thread->next_thread_in_wait_queue_;
+    thread->next_thread_in_wait_queue_ = 0;
+    thread->wait_queue_ = 0;
+    wake(thread);
+    thread = next;
+    ++count;
+  }
+  lock_.releaseIrqRestore(interrupts_enabled);
+  return count;
+}
+
+void WaitQueue::wake(Thread* thread)
+{
+  // a thread which is not sleeping yet (or has been woken up by its timeout) notices
+  // that it is not on the queue any longer and does not go to sleep
+  if (thread->state_ == Sleeping)
+    Scheduler::instance()->wake(thread);
+}
+
+void WaitQueue::append(Thread* thread)
+{
+  assert(!thread->wait_queue_);
+  thread->wait_queue_ = this;
+  thread->next_thread_in_wait_queue_ = 0;
+  if (tail_)
+    tail_->next_thread_in_wait_queue_ = thread;
+  else
+    head_ = thread;
+  tail_ = thread;
+}
+
+Thread* WaitQueue::popFront()
+{
+  Thread* thread = head_;
+  if (!thread)
+    return 0;
+  head_ = thread->next_thread_in_wait_queue_;
+  if (!head_)
+    tail_ = 0;
+  thread->next_thread_in_wait_queue_ = 0;
+  thread->wait_queue_ = 0;
+  return thread;
+}
+
+void WaitQueue::remove(Thread* thread)
+{
+  Thread* previous = 0;
+  for (Thread* current = head_; current; previous = current, current = current->next_thread_in_wait_queue_)
+  {
+    if (current != thread)
+      continue;
+    if (previous)
+      previous->next_thread_in_wait_queue_ = thread->next_thread_in_wait_queue_;
+    else
+      head_ = thread->next_thread_in_wait_queue_;
+    if (tail_ == thread)
+      tail_ = previous;
+    break;
+  }
+  thread->next_thread_in_wait_queue_ = 0;
+  thread->wait_queue_ = 0;
+}
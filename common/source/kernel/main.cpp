@@ -13,9 +13,11 @@
 #include "ArchCommon.h"
 #include "ArchThreads.h"
 #include "Mutex.h"
+#include "RWLock.h"
 #include "debug_bochs.h"
 #include "ArchMemory.h"
 #include "Loader.h"
+#include "Futex.h"
 #include "assert.h"
 #include "SerialManager.h"
 #include "KeyboardManager.h"
@@ -23,6 +25,8 @@
 #include "FileSystemInfo.h"
 #include "Dentry.h"
 #include "DeviceFSType.h"
+#include "DeviceFSSuperblock.h"
+#include "LockStatisticsInode.h"
 #include "VirtualFileSystem.h"
 #include "TextConsole.h"
 #include "FrameBufferConsole.h"
@@ -73,26 +77,35 @@ extern "C" void startup()
 
   ArchCommon::initDebug();
 
+  // global constructors are not called, the locks of the vfs are needed from the first mount on
+  extern RWLock vfs_lock;
+  new (&vfs_lock) RWLock("vfs_lock");
+  extern Mutex open_files_lock;
+  new (&open_files_lock) Mutex("open_files_lock");
+  extern Mutex load_children_lock;
+  new (&load_children_lock) Mutex("MinixFSInode::load_children_lock");
+
   vfs.initialize();
   debug(MAIN, "Mounting DeviceFS under /dev/\n");
   DeviceFSType *devfs = new DeviceFSType();
   vfs.registerFileSystem(devfs);
   default_working_dir = vfs.root_mount("devicefs", 0);
+  DeviceFSSuperBlock::getInstance()->addDevice(new LockStatisticsInode(DeviceFSSuperBlock::getInstance()), "lockstat");
 
   debug(MAIN, "Block Device creation\n");
   BDManager::getInstance()->doDeviceDetection();
   debug(MAIN, "Block Device done\n");
 
-  for (BDVirtualDevice* bdvd : BDManager::getInstance()->device_list_)
+  for (BDVirtualDevice* bdvd : BDManager::getInstance()->device_list_.read())
   {
     debug(MAIN, "Detected Device: %s :: %d\n", bdvd->getName(), bdvd->getDeviceNumber());
   }
 
   // initialise global and static objects
-  extern ustl::list<FileDescriptor*> global_fd;
-  new (&global_fd) ustl::list<FileDescriptor*>();
   extern Mutex global_fd_lock;
   new (&global_fd_lock) Mutex("global_fd_lock");
+  // before the first user thread can make a futex syscall, see Futex::instance()
+  Futex::instance();
 
   debug(MAIN, "make a deep copy of FsWorkingDir\n");
   main_console->setWorkingDirInfo(new FileSystemInfo(*default_working_dir));
@@ -114,6 +127,8 @@ extern "C" void startup()
   ArchInterrupts::enableKBD();
 
   debug(MAIN, "Adding Kernel threads\n");
+  // the console thread handles the keyboard input
+  Scheduler::instance()->setScheduling(main_console, SCHED_CLASS_RT, KERNEL_RT_PRIORITY);
   Scheduler::instance()->addNewThread(main_console);
   Scheduler::instance()->addNewThread(new ProcessRegistry(new FileSystemInfo(*default_working_dir), user_progs /*see user_progs.h*/));
   Scheduler::instance()->printThreadList();
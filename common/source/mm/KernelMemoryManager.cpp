@@ -10,6 +10,9 @@
 #include "PageManager.h"
 #include "kstring.h"
 
+// the pages ksbrk takes from the PageManager at once
+#define KMM_KSBRK_BATCH 16
+
 KernelMemoryManager kmm;
 
 KernelMemoryManager * KernelMemoryManager::instance_;
@@ -40,6 +43,10 @@ KernelMemoryManager::KernelMemoryManager(size_t min_heap_pages, size_t max_heap_
   first_ = (MallocSegment*)start_address;
   new ((void*)start_address) MallocSegment(0, 0, min_heap_pages * PAGE_SIZE - sizeof(MallocSegment), false);
   last_ = first_;
+  memset(free_lists_, 0, sizeof(free_lists_));
+  first_level_bitmap_ = 0;
+  memset(second_level_bitmaps_, 0, sizeof(second_level_bitmaps_));
+  insertFreeSegment(first_);
   debug(KMM, "KernelMemoryManager::ctor, Heap starts at %x and initially ends at %x\n", start_address, start_address + min_heap_pages * PAGE_SIZE);
 }
 
@@ -48,6 +55,8 @@ pointer KernelMemoryManager::allocateMemory(size_t requested_size)
   prenew_assert((requested_size & 0x80000000) == 0);
   if ((requested_size & 0xF) != 0)
     requested_size += 0x10 - (requested_size & 0xF); // 16 byte alignment
+  if (requested_size < KMM_MIN_FREE_SIZE)
+    requested_size = KMM_MIN_FREE_SIZE;
   lockKMM();
   pointer ptr = private_AllocateMemory(requested_size);
   if (ptr)
@@ -108,6 +117,8 @@ pointer KernelMemoryManager::reallocateMemory(pointer virtual_address, size_t ne
   //iff the old segment is no segment ;) -> we create a new one
   if (virtual_address == 0)
     return allocateMemory(new_size);
+  if ((new_size & 0xF) != 0)
+    new_size += 0x10 - (new_size & 0xF); // 16 byte alignment, as in allocateMemory
 
   lockKMM();
 
@@ -174,17 +185,31 @@ MallocSegment *KernelMemoryManager::findFreeSegment(size_t requested_size)
 {
   debug(KMM, "findFreeSegment: seeking memory block of bytes: %d \n", requested_size + sizeof(MallocSegment));
 
-  MallocSegment *current = first_;
-  while (current != 0)
-  {
-    debug(KMM, "findFreeSegment: current: %x size: %d used: %d \n", current, current->getSize() + sizeof(MallocSegment),
-          current->getUsed());
-    prenew_assert(current->marker_ == 0xdeadbeef);
-    if ((current->getSize() >= requested_size) && (current->getUsed() == false))
-      return current;
+  // round up to the next free list, every segment in it or in the ones above is large enough
+  size_t first_level;
+  size_t second_level;
+  getFreeList(requested_size, first_level, second_level);
+  getFreeList(requested_size + (1 << (first_level - KMM_SECOND_LEVEL_BITS)) - 1, first_level, second_level);
 
-    current = current->next_;
+  uint32 second_level_bitmap = second_level_bitmaps_[first_level] & (~0U << second_level);
+  if (!second_level_bitmap)
+  {
+    uint32 first_level_bitmap = (first_level + 1 < KMM_FIRST_LEVELS) ? first_level_bitmap_ & (~0U << (first_level + 1)) : 0;
+    if (first_level_bitmap)
+    {
+      first_level = __builtin_ctz(first_level_bitmap);
+      second_level_bitmap = second_level_bitmaps_[first_level];
+    }
+  }
+  if (second_level_bitmap)
+  {
+    MallocSegment *segment = free_lists_[first_level][__builtin_ctz(second_level_bitmap)];
+    prenew_assert(segment->marker_ == 0xdeadbeef);
+    prenew_assert(segment->getUsed() == false && segment->getSize() >= requested_size);
+    removeFreeSegment(segment);
+    return segment;
   }
+
   // No free segment found, could we allocate more memory?
   if(last_->getUsed())
   {
@@ -195,15 +220,73 @@ MallocSegment *KernelMemoryManager::findFreeSegment(size_t requested_size)
   }
   else
   {
-    // else we just increase the size of the last segment
-    size_t needed_size = requested_size - last_->getSize();
-    ksbrk(needed_size);
-    last_->setSize(requested_size);
+    removeFreeSegment(last_);
+    // the last segment might be large enough but in a free list below the rounded up one,
+    // else we just increase its size
+    if (last_->getSize() < requested_size)
+    {
+      size_t needed_size = requested_size - last_->getSize();
+      ksbrk(needed_size);
+      last_->setSize(requested_size);
+    }
   }
 
   return last_;
 }
 
+void KernelMemoryManager::getFreeList(size_t size, size_t& first_level, size_t& second_level)
+{
+  prenew_assert(size >= KMM_MIN_FREE_SIZE);
+  first_level = 31 - __builtin_clz((uint32) size);
+  second_level = (size >> (first_level - KMM_SECOND_LEVEL_BITS)) & (KMM_SECOND_LEVELS - 1);
+}
+
+void KernelMemoryManager::insertFreeSegment(MallocSegment *segment)
+{
+  prenew_assert(segment->getUsed() == false);
+  if (segment->getSize() < KMM_MIN_FREE_SIZE)
+    return;
+  size_t first_level;
+  size_t second_level;
+  getFreeList(segment->getSize(), first_level, second_level);
+  MallocSegment *&list = free_lists_[first_level][second_level];
+  segment->previousFree() = 0;
+  segment->nextFree() = list;
+  if (list)
+    list->previousFree() = segment;
+  list = segment;
+  first_level_bitmap_ |= 1U << first_level;
+  second_level_bitmaps_[first_level] |= 1U << second_level;
+}
+
+void KernelMemoryManager::removeFreeSegment(MallocSegment *segment)
+{
+  prenew_assert(segment->getUsed() == false);
+  if (segment->getSize() < KMM_MIN_FREE_SIZE)
+    return;
+  size_t first_level;
+  size_t second_level;
+  getFreeList(segment->getSize(), first_level, second_level);
+  if (segment->previousFree())
+    segment->previousFree()->nextFree() = segment->nextFree();
+  else
+  {
+    prenew_assert(free_lists_[first_level][second_level] == segment);
+    free_lists_[first_level][second_level] = segment->nextFree();
+  }
+  if (segment->nextFree())
+    segment->nextFree()->previousFree() = segment->previousFree();
+  if (!free_lists_[first_level][second_level])
+  {
+    second_level_bitmaps_[first_level] &= ~(1U << second_level);
+    if (!second_level_bitmaps_[first_level])
+      first_level_bitmap_ &= ~(1U << first_level);
+  }
+  // used memory is expected to be zero
+  segment->nextFree() = 0;
+  segment->previousFree() = 0;
+}
+
 void KernelMemoryManager::fillSegment(MallocSegment *this_one, size_t requested_size, uint32 zero_check)
 {
   prenew_assert(this_one != 0);
@@ -229,7 +312,7 @@ void KernelMemoryManager::fillSegment(MallocSegment *this_one, size_t requested_
   prenew_assert(this_one->getUsed() == true);
 
   //add a free segment after this one, if there's enough space
-  if (space_left > sizeof(MallocSegment))
+  if (space_left >= sizeof(MallocSegment) + KMM_MIN_FREE_SIZE)
   {
     this_one->setSize(requested_size);
     prenew_assert(this_one->getSize() == requested_size);
@@ -247,6 +330,7 @@ void KernelMemoryManager::fillSegment(MallocSegment *this_one, size_t requested_
 
     if (new_segment->next_ == 0)
       last_ = new_segment;
+    insertFreeSegment(new_segment);
   }
   debug(KMM, "fillSegment: filled memory block of bytes: %d \n", this_one->getSize() + sizeof(MallocSegment));
 }
@@ -279,6 +363,7 @@ void KernelMemoryManager::freeSegment(MallocSegment *this_one)
                                    ((pointer) this_one->next_) - ((pointer) this_one));
 
       MallocSegment *previous_one = this_one->prev_;
+      removeFreeSegment(previous_one);
 
       previous_one->setSize(my_true_size + previous_one->getSize());
       previous_one->next_ = this_one->next_;
@@ -317,7 +402,11 @@ void KernelMemoryManager::freeSegment(MallocSegment *this_one)
         prenew_assert(this_one && this_one->prev_ && this_one->prev_->marker_ == 0xdeadbeef);
         this_one->prev_->next_ = 0;
         last_ = this_one->prev_;
-        ksbrk(-(this_one->getSize() + sizeof(MallocSegment)));
+        // the page might stay mapped, the heap grows into it again later on
+        ssize_t size = this_one->getSize() + sizeof(MallocSegment);
+        memset((void*) this_one, 0, sizeof(MallocSegment));
+        ksbrk(-size);
+        this_one = 0;
       }
       else if((size_t)this_one + sizeof(MallocSegment) + this_one->getSize() <= base_break_ + reserved_min_)
       {
@@ -345,16 +434,24 @@ void KernelMemoryManager::freeSegment(MallocSegment *this_one)
     }
   }
 
-  {
-    MallocSegment *current = first_;
-    while (current != 0)
-    {
-      debug(KMM, "freeSegment: current: %x prev: %x next: %x size: %d used: %d\n", current, current->prev_,
-            current->next_, current->getSize() + sizeof(MallocSegment), current->getUsed());
-      prenew_assert(current->marker_ == 0xdeadbeef);
-      current = current->next_;
-    }
+  if (this_one)
+    insertFreeSegment(this_one);
+
+  checkSegments();
+}
 
+void KernelMemoryManager::checkSegments()
+{
+  // walking the whole heap would make every free as slow as the heap is large
+  if (!(KMM & OUTPUT_ENABLED))
+    return;
+  MallocSegment *current = first_;
+  while (current != 0)
+  {
+    debug(KMM, "checkSegments: current: %x prev: %x next: %x size: %d used: %d\n", current, current->prev_,
+          current->next_, current->getSize() + sizeof(MallocSegment), current->getUsed());
+    prenew_assert(current->marker_ == 0xdeadbeef);
+    current = current->next_;
   }
 }
 
@@ -369,6 +466,7 @@ bool KernelMemoryManager::mergeWithFollowingFreeSegment(MallocSegment *this_one)
     if (this_one->next_->getUsed() == false)
     {
       MallocSegment *next_one = this_one->next_;
+      removeFreeSegment(next_one);
       size_t true_next_size = (
           (next_one->next_ == 0) ? kernel_break_ - ((pointer) next_one) :
                                    ((pointer) next_one->next_) - ((pointer) next_one));
@@ -417,19 +515,24 @@ pointer KernelMemoryManager::ksbrk(ssize_t size)
       while(cur_top_vpn != new_top_vpn)
       {
         debug(KMM, "%x != %x\n", cur_top_vpn, new_top_vpn);
-        cur_top_vpn++;
         assert(pm_ready_);
-        size_t new_page = PageManager::instance()->allocPPN();
-        if(unlikely(new_page == 0))
+        // the pages are taken from the PageManager in batches
+        uint32 new_pages[KMM_KSBRK_BATCH];
+        size_t num_pages = Min(new_top_vpn - cur_top_vpn, (size_t) KMM_KSBRK_BATCH);
+        if(unlikely(PageManager::instance()->allocPPNs(new_pages, num_pages) != num_pages))
         {
           debug(KMM, "KernelMemoryManager::ksbrk(%d)4\n", size);
           kprintfd("KernelMemoryManager::freeSegment: FATAL ERROR\n");
           kprintfd("KernelMemoryManager::freeSegment: no more physical memory\n");
-          prenew_assert(new_page != 0);
+          prenew_assert(false);
+        }
+        for (size_t i = 0; i < num_pages; ++i)
+        {
+          cur_top_vpn++;
+          debug(KMM, "kbsrk: map %x -> %x\n", cur_top_vpn, new_pages[i]);
+          memset((void*)ArchMemory::getIdentAddressOfPPN(new_pages[i]), 0 , PAGE_SIZE);
+          ArchMemory::mapKernelPage(cur_top_vpn, new_pages[i]);
         }
-        debug(KMM, "kbsrk: map %x -> %x\n", cur_top_vpn, new_page);
-        memset((void*)ArchMemory::getIdentAddressOfPPN(new_page), 0 , PAGE_SIZE);
-        ArchMemory::mapKernelPage(cur_top_vpn, new_page);
       }
 
     }
@@ -474,3 +577,51 @@ Mutex& KernelMemoryManager::getKMMLock()
 {
   return lock_;
 }
+
+#define KMM_BENCHMARK_BLOCKS 4000
+#define KMM_BENCHMARK_OPERATIONS 50000
+#define KMM_BENCHMARK_MAX_SIZE 512
+
+void KernelMemoryManager::benchmark()
+{
+  pointer* blocks = (pointer*) allocateMemory(KMM_BENCHMARK_BLOCKS * sizeof(pointer));
+  uint32 seed = 12345;
+
+  // every second block is freed again, the heap is full of small holes afterwards
+  for (size_t i = 0; i < KMM_BENCHMARK_BLOCKS; ++i)
+  {
+    seed = seed * 1103515245 + 12345;
+    blocks[i] = allocateMemory(KMM_MIN_FREE_SIZE + (seed >> 16) % KMM_BENCHMARK_MAX_SIZE);
+  }
+  for (size_t i = 0; i < KMM_BENCHMARK_BLOCKS; i += 2)
+  {
+    freeMemory(blocks[i]);
+    blocks[i] = 0;
+  }
+
+  // then blocks are allocated and freed at random
+  uint64 start = ArchCommon::getCycleCount();
+  for (size_t i = 0; i < KMM_BENCHMARK_OPERATIONS; ++i)
+  {
+    seed = seed * 1103515245 + 12345;
+    size_t block = (seed >> 16) % KMM_BENCHMARK_BLOCKS;
+    if (blocks[block])
+    {
+      freeMemory(blocks[block]);
+      blocks[block] = 0;
+    }
+    else
+    {
+      seed = seed * 1103515245 + 12345;
+      blocks[block] = allocateMemory(KMM_MIN_FREE_SIZE + (seed >> 16) % KMM_BENCHMARK_MAX_SIZE);
+    }
+  }
+  uint64 cycles = ArchCommon::getCycleCount() - start;
+
+  for (size_t i = 0; i < KMM_BENCHMARK_BLOCKS; ++i)
+    freeMemory(blocks[i]);
+  freeMemory((pointer) blocks);
+  kprintfd("KernelMemoryManager::benchmark: %d allocations and frees of up to %d bytes among %d blocks, "
+        "%d cycles each\n", KMM_BENCHMARK_OPERATIONS, KMM_BENCHMARK_MAX_SIZE, KMM_BENCHMARK_BLOCKS,
+        (size_t) (cycles / KMM_BENCHMARK_OPERATIONS));
+}
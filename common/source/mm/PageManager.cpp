@@ -10,6 +10,8 @@
 #include "KernelMemoryManager.h"
 #include "assert.h"
 #include "Bitmap.h"
+#include "MutexLock.h"
+#include "kstring.h"
 
 PageManager pm;
 
@@ -24,6 +26,11 @@ PageManager* PageManager::instance_ = 0;
 #define MIN_HEAP_PAGES 1
 #define MAX_HEAP_PAGES 4096 // 4096 pages, because maximum heap size is 16MiB
 
+// the end of a free list, page 0 is never free
+#define PM_NO_PAGE 0xFFFFFFFF
+// the page does not start a free block
+#define PM_NO_BLOCK 0xFF
+
 PageManager* PageManager::instance()
 {
   if (unlikely(!instance_))
@@ -37,11 +44,11 @@ PageManager::PageManager() : lock_("PageManager::lock_")
   instance_ = this;
   assert(KernelMemoryManager::instance_ == 0);
   number_of_pages_ = 0;
-  lowest_unreserved_page_ = 0;
+  uint32 lowest_unreserved_page = 0;
 
   size_t num_mmaps = ArchCommon::getNumUseableMemoryRegions();
 
-  pointer start_address = 0, end_address = 0, last_end_page = lowest_unreserved_page_;
+  pointer start_address = 0, end_address = 0, last_end_page = lowest_unreserved_page;
   size_t highest_address = 0, type = 0, used_pages = 0;
 
   //Determine Amount of RAM
@@ -67,7 +74,7 @@ PageManager::PageManager() : lock_("PageManager::lock_")
     used_pages += end_page - start_page + ((i > 0 && end_page == last_end_page) ? 0 : 1);
     last_end_page = end_page;
   }
-  lowest_unreserved_page_ = last_end_page;
+  lowest_unreserved_page = last_end_page;
 
   //need at least 4 MiB for Kernel Memory + first physical MiB
   if (number_of_pages_ < 1000)
@@ -76,7 +83,9 @@ PageManager::PageManager() : lock_("PageManager::lock_")
     prenew_assert(false);
   }
 
-  size_t num_pages_for_bitmap = (number_of_pages_ / 8) / PAGE_SIZE + 1;
+  // the bitmap and the free block links are allocated before the heap can grow
+  size_t num_pages_for_bitmap = (number_of_pages_ / 8 + number_of_pages_ * (2 * sizeof(uint32) + sizeof(uint8)))
+                                / PAGE_SIZE + 2;
   size_t start_vpn = ArchCommon::getFreeKernelMemoryStart() / PAGE_SIZE;
   size_t last_free_page = number_of_pages_-1;
   size_t temp_page_size = 0;
@@ -92,14 +101,14 @@ PageManager::PageManager() : lock_("PageManager::lock_")
   extern KernelMemoryManager kmm;
   new (&kmm) KernelMemoryManager(num_reserved_heap_pages,MAX_HEAP_PAGES);
   page_usage_table_ = new Bitmap(number_of_pages_);
+  next_free_block_ = new uint32[number_of_pages_];
+  previous_free_block_ = new uint32[number_of_pages_];
+  free_block_order_ = new uint8[number_of_pages_];
 
   // since we have gaps in the memory maps we can not give out everything
   // first mark everything as reserved, just to be sure
   debug(PM, "Ctor: Initializing page_usage_table_ with all pages reserved\n");
-  for (size_t i = 0; i < number_of_pages_; ++i)
-  {
-    page_usage_table_->setBit(i);
-  }
+  page_usage_table_->setRange(0, number_of_pages_);
 
   //now mark as free, everything that might be useable
   for (size_t i = 0; i < num_mmaps; ++i)
@@ -111,10 +120,10 @@ PageManager::PageManager() : lock_("PageManager::lock_")
     uint32 end_page = end_address / PAGE_SIZE;
     debug(PM, "Ctor: usable memory region: start_page: %d, end_page: %d, type: %d\n", start_page, end_page, type);
 
-    for (size_t k = Max(start_page, lowest_unreserved_page_); k < Min(end_page, number_of_pages_); ++k)
-    {
-      page_usage_table_->unsetBit(k);
-    }
+    start_page = Max(start_page, lowest_unreserved_page);
+    end_page = Min(end_page, number_of_pages_);
+    if (start_page < end_page)
+      page_usage_table_->clearRange(start_page, end_page - start_page);
   }
 
   //some of the usable memory regions are already in use by the kernel (within first 1024 pages)
@@ -131,9 +140,9 @@ PageManager::PageManager() : lock_("PageManager::lock_")
     {
       //our bitmap only knows 4k pages for now
       uint64 num_4kpages = this_page_size / PAGE_SIZE; //should be 1 on 4k pages and 1024 on 4m pages
-      for (uint64 p = 0; p < num_4kpages; ++p)
-        if (physical_page * num_4kpages + p < number_of_pages_)
-          page_usage_table_->setBit(physical_page * num_4kpages + p);
+      if (physical_page * num_4kpages < number_of_pages_)
+        page_usage_table_->setRange(physical_page * num_4kpages,
+                                    Min(num_4kpages, number_of_pages_ - physical_page * num_4kpages));
       i += (num_4kpages - 1); //+0 in most cases
       if (num_4kpages == 1 && i % 1024 == 0 && pte_page < number_of_pages_)
         page_usage_table_->setBit(pte_page);
@@ -147,22 +156,32 @@ PageManager::PageManager() : lock_("PageManager::lock_")
     uint32 start_page = (ArchCommon::getModuleStartAddress(i) & 0x7FFFFFFF) / PAGE_SIZE;
     uint32 end_page = (ArchCommon::getModuleEndAddress(i) & 0x7FFFFFFF) / PAGE_SIZE;
     debug(PM, "Ctor: module: start_page: %d, end_page: %d, type: %d\n", start_page, end_page, type);
-    for (size_t k = Min(start_page, number_of_pages_); k <= Min(end_page, number_of_pages_ - 1); ++k)
-      page_usage_table_->setBit(k);
+    start_page = Min(start_page, number_of_pages_);
+    end_page = Min(end_page + 1, number_of_pages_);
+    if (start_page < end_page)
+      page_usage_table_->setRange(start_page, end_page - start_page);
   }
 
-  debug(PM, "Ctor: find lowest unreserved page\n");
-  for (size_t p = lowest_unreserved_page_; p < number_of_pages_; ++p)
+  // allocPPN returns 0 if it fails
+  if (!page_usage_table_->getBit(0))
+    page_usage_table_->setBit(0);
+
+  debug(PM, "Ctor: Building the free lists\n");
+  for (uint32 order = 0; order <= PM_MAX_ORDER; ++order)
+    free_lists_[order] = PM_NO_PAGE;
+  memset(free_block_order_, PM_NO_BLOCK, number_of_pages_);
+  size_t p = 0;
+  while ((p = page_usage_table_->findFirstZero(p)) != Bitmap::NOT_FOUND)
   {
-    if (!page_usage_table_->getBit(p))
-    {
-      lowest_unreserved_page_ = p;
-      break;
-    }
+    size_t end = page_usage_table_->findFirstOne(p);
+    if (end == Bitmap::NOT_FOUND)
+      end = number_of_pages_;
+    freeRange(p, end - p);
+    p = end;
   }
   debug(PM, "Ctor: Physical pages - free: %u used: %u total: %u\n", page_usage_table_->getNumFreeBits(),
         page_usage_table_->getNumBitsSet(), number_of_pages_);
-  prenew_assert(lowest_unreserved_page_ < number_of_pages_);
+  prenew_assert(page_usage_table_->getNumFreeBits() > 0);
   KernelMemoryManager::pm_ready_ = 1;
 }
 
@@ -171,60 +190,148 @@ uint32 PageManager::getTotalNumPages() const
   return number_of_pages_;
 }
 
-bool PageManager::reservePages(uint32 ppn, uint32 num)
+uint32 PageManager::allocPPN(uint32 page_size)
 {
-  assert(lock_.heldBy() == currentThread);
-  if (ppn < number_of_pages_ && !page_usage_table_->getBit(ppn))
+  uint32 found = tryAllocPPN(page_size);
+  if (found == 0)
   {
-    if (num == 1 || reservePages(ppn + 1, num - 1))
-    {
-      page_usage_table_->setBit(ppn);
-      return true;
-    }
+    debug(PM, "PageManager::allocPPN: FATAL ERROR!\n");
+    debug(PM, "PageManager::allocPPN: Out of phyiscal pages!\n");
+    assert(found);
   }
-  return false;
+  return found;
 }
 
-uint32 PageManager::allocPPN(uint32 page_size)
+uint32 PageManager::tryAllocPPN(uint32 page_size)
 {
   assert((page_size % PAGE_SIZE) == 0);
-  while (1)
-  {
-    lock_.acquire();
-    uint32 p;
-    uint32 found = 0;
-    for (p = lowest_unreserved_page_; !found && p < number_of_pages_; ++p)
-    {
-      if ((p % (page_size / PAGE_SIZE)) != 0)
-        continue;
-      if (reservePages(p, page_size / PAGE_SIZE))
-        found = p;
-    }
-    while (lowest_unreserved_page_ < number_of_pages_ && page_usage_table_->getBit(lowest_unreserved_page_))
-      ++lowest_unreserved_page_;
-    lock_.release();
+  uint32 num = page_size / PAGE_SIZE;
+  uint32 order = 0;
+  while ((1U << order) < num)
+    ++order;
+  assert((1U << order) == num && order <= PM_MAX_ORDER);
 
-    if (found == 0)
-    {
-      debug(PM, "PageManager::allocPPN: FATAL ERROR!\n");
-      debug(PM, "PageManager::allocPPN: Out of phyiscal pages!\n");
-      assert(found);
-    }
-    return found;
+  lock_.acquire();
+  uint32 found = allocBlock(order);
+  lock_.release();
+  return found;
+}
+
+size_t PageManager::allocPPNs(uint32* ppns, size_t num)
+{
+  size_t allocated = 0;
+  lock_.acquire();
+  while (allocated < num)
+  {
+    uint32 ppn = allocBlock(0);
+    if (ppn == 0)
+      break;
+    ppns[allocated++] = ppn;
   }
-  return 0;
+  lock_.release();
+  return allocated;
 }
 
 void PageManager::freePPN(uint32 page_number, uint32 page_size)
 {
   assert((page_size % PAGE_SIZE) == 0);
+  uint32 num = page_size / PAGE_SIZE;
   lock_.acquire();
-  if (page_number < lowest_unreserved_page_)
-    lowest_unreserved_page_ = page_number;
-  for (uint32 p = page_number; p < (page_number + page_size / PAGE_SIZE); ++p)
+  // all of the pages have to be in use
+  assert(page_usage_table_->findFirstZero(page_number) >= page_number + num);
+  page_usage_table_->clearRange(page_number, num);
+  freeRange(page_number, num);
+  lock_.release();
+}
+
+uint32 PageManager::getNumFreePages()
+{
+  MutexLock lock(lock_);
+  return page_usage_table_->getNumFreeBits();
+}
+
+uint32 PageManager::allocBlock(uint32 order)
+{
+  assert(lock_.heldBy() == currentThread);
+  uint32 current = order;
+  while (current <= PM_MAX_ORDER && free_lists_[current] == PM_NO_PAGE)
+    ++current;
+  if (current > PM_MAX_ORDER)
+    return 0;
+
+  uint32 ppn = free_lists_[current];
+  removeFreeBlock(ppn);
+  // the upper halves go back to the lists of the lower orders
+  while (current > order)
   {
-    assert(page_usage_table_->getBit(p))
-    page_usage_table_->unsetBit(p);
+    --current;
+    insertFreeBlock(ppn + (1U << current), current);
   }
-  lock_.release();
+  assert(page_usage_table_->findFirstOne(ppn) >= ppn + (1U << order));
+  page_usage_table_->setRange(ppn, 1U << order);
+  return ppn;
+}
+
+void PageManager::freeBlock(uint32 ppn, uint32 order)
+{
+  while (order < PM_MAX_ORDER)
+  {
+    uint32 buddy = ppn ^ (1U << order);
+    if (buddy >= number_of_pages_ || free_block_order_[buddy] != order)
+      break;
+    removeFreeBlock(buddy);
+    ppn &= ~(1U << order);
+    ++order;
+  }
+  insertFreeBlock(ppn, order);
+}
+
+void PageManager::freeRange(uint32 ppn, uint32 num)
+{
+  while (num > 0)
+  {
+    uint32 order = 0;
+    while (order < PM_MAX_ORDER && (ppn & ((2U << order) - 1)) == 0 && (2U << order) <= num)
+      ++order;
+    freeBlock(ppn, order);
+    ppn += 1U << order;
+    num -= 1U << order;
+  }
+}
+
+void PageManager::insertFreeBlock(uint32 ppn, uint32 order)
+{
+  free_block_order_[ppn] = order;
+  previous_free_block_[ppn] = PM_NO_PAGE;
+  next_free_block_[ppn] = free_lists_[order];
+  if (free_lists_[order] != PM_NO_PAGE)
+    previous_free_block_[free_lists_[order]] = ppn;
+  free_lists_[order] = ppn;
+}
+
+void PageManager::removeFreeBlock(uint32 ppn)
+{
+  uint32 order = free_block_order_[ppn];
+  assert(order <= PM_MAX_ORDER);
+  if (previous_free_block_[ppn] != PM_NO_PAGE)
+    next_free_block_[previous_free_block_[ppn]] = next_free_block_[ppn];
+  else
+    free_lists_[order] = next_free_block_[ppn];
+  if (next_free_block_[ppn] != PM_NO_PAGE)
+    previous_free_block_[next_free_block_[ppn]] = previous_free_block_[ppn];
+  free_block_order_[ppn] = PM_NO_BLOCK;
+}
+
+void PageManager::printBitmap()
+{
+  page_usage_table_->bmprint();
+  MutexLock lock(lock_);
+  for (uint32 order = 0; order <= PM_MAX_ORDER; ++order)
+  {
+    size_t blocks = 0;
+    for (uint32 ppn = free_lists_[order]; ppn != PM_NO_PAGE; ppn = next_free_block_[ppn])
+      ++blocks;
+    kprintfd("PageManager: %d free blocks of %d pages\n", blocks, 1U << order);
+  }
+  kprintfd("PageManager: %d KiB of user memory mapped in huge pages\n", ArchMemory::getHugePageMemory() / 1024);
 }
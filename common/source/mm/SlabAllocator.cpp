@@ -0,0 +1,205 @@
+#include "SlabAllocator.h"
+#include "PageManager.h"
+#include "ArchMemory.h"
+#include "MutexLock.h"
+#include "kprintf.h"
+#include "kstring.h"
+#include "assert.h"
+
+// a slab grows (in powers of two pages) until it holds at least this many objects
+#define SLAB_MIN_OBJECTS 8
+#define SLAB_MAX_PAGES 16
+// the empty slabs a cache keeps, the pages of the others are given back to the PageManager
+#define SLAB_MAX_EMPTY 2
+// the alignment of the objects, as the KernelMemoryManager does it
+#define SLAB_ALIGNMENT 0x10
+
+#define SLAB_ALIGN(x) (((x) + SLAB_ALIGNMENT - 1) & ~((size_t) SLAB_ALIGNMENT - 1))
+
+SlabCache::SlabCache(const char* name, size_t object_size) :
+    name_(name), object_size_(SLAB_ALIGN(Max(object_size, sizeof(void*)))), slab_pages_(1), objects_per_slab_(0),
+    partial_(0), full_(0), empty_(0), empty_slabs_(0), lock_("SlabCache::lock_"), slabs_(0), objects_in_use_(0),
+    peak_objects_in_use_(0), allocations_(0), fallback_allocations_(0), next_cache_(0)
+{
+  while ((slab_pages_ * PAGE_SIZE - SLAB_ALIGN(sizeof(Slab))) / object_size_ < SLAB_MIN_OBJECTS
+         && slab_pages_ < SLAB_MAX_PAGES)
+    slab_pages_ *= 2;
+  objects_per_slab_ = (slab_pages_ * PAGE_SIZE - SLAB_ALIGN(sizeof(Slab))) / object_size_;
+  assert(objects_per_slab_ > 0 && "object too big for a slab cache");
+  debug(SLAB, "SlabCache %s: %d byte objects, %d per slab of %d pages\n", name_, object_size_, objects_per_slab_,
+        slab_pages_);
+}
+
+void* SlabCache::allocate(size_t size)
+{
+  if (unlikely(size > object_size_))
+  {
+    // a derived class which does not fit
+    fallback_allocations_.fetchAdd(1, MEMORY_ORDER_RELAXED);
+    return ::operator new(size);
+  }
+
+  MutexLock lock(lock_);
+  Slab* slab = partial_;
+  if (!slab)
+  {
+    slab = empty_;
+    if (slab)
+    {
+      unlink(empty_, slab);
+      --empty_slabs_;
+    }
+    else
+      slab = createSlab();
+    pushFront(partial_, slab);
+  }
+
+  void* object = slab->free_list_;
+  slab->free_list_ = *(void**) object;
+  if (++slab->objects_in_use_ == objects_per_slab_)
+  {
+    unlink(partial_, slab);
+    pushFront(full_, slab);
+  }
+
+  ++allocations_;
+  if (++objects_in_use_ > peak_objects_in_use_)
+    peak_objects_in_use_ = objects_in_use_;
+  // the KernelMemoryManager hands out zeroed memory, constructors rely on that
+  memset(object, 0, object_size_);
+  return object;
+}
+
+void SlabCache::free(void* object, size_t size)
+{
+  if (!object)
+    return;
+  if (unlikely(size > object_size_))
+  {
+    ::operator delete(object);
+    return;
+  }
+
+  Slab* slab = (Slab*) ((pointer) object & ~((pointer) slab_pages_ * PAGE_SIZE - 1));
+  assert((pointer) object >= (pointer) slab + SLAB_ALIGN(sizeof(Slab)) &&
+         ((pointer) object - (pointer) slab - SLAB_ALIGN(sizeof(Slab))) % object_size_ == 0);
+
+  MutexLock lock(lock_);
+  assert(slab->objects_in_use_ > 0);
+  if (slab->objects_in_use_-- == objects_per_slab_)
+  {
+    unlink(full_, slab);
+    pushFront(partial_, slab);
+  }
+  *(void**) object = slab->free_list_;
+  slab->free_list_ = object;
+  --objects_in_use_;
+
+  if (!slab->objects_in_use_)
+  {
+    unlink(partial_, slab);
+    if (empty_slabs_ < SLAB_MAX_EMPTY)
+    {
+      pushFront(empty_, slab);
+      ++empty_slabs_;
+    }
+    else
+      destroySlab(slab);
+  }
+}
+
+SlabCache::Slab* SlabCache::createSlab()
+{
+  // the PageManager aligns the pages to the size of the slab, the identity mapping keeps that alignment
+  size_t ppn = PageManager::instance()->allocPPN(slab_pages_ * PAGE_SIZE);
+  Slab* slab = (Slab*) ArchMemory::getIdentAddressOfPPN(ppn);
+  slab->next_ = 0;
+  slab->prev_ = 0;
+  slab->objects_in_use_ = 0;
+  slab->ppn_ = ppn;
+
+  // the free list starts with the lowest object
+  slab->free_list_ = 0;
+  pointer first_object = (pointer) slab + SLAB_ALIGN(sizeof(Slab));
+  for (size_t i = objects_per_slab_; i > 0; --i)
+  {
+    void* object = (void*) (first_object + (i - 1) * object_size_);
+    *(void**) object = slab->free_list_;
+    slab->free_list_ = object;
+  }
+  ++slabs_;
+  return slab;
+}
+
+void SlabCache::destroySlab(Slab* slab)
+{
+  --slabs_;
+  PageManager::instance()->freePPN(slab->ppn_, slab_pages_ * PAGE_SIZE);
+}
+
+void SlabCache::pushFront(Slab*& list, Slab* slab)
+{
+  slab->prev_ = 0;
+  slab->next_ = list;
+  if (list)
+    list->prev_ = slab;
+  list = slab;
+}
+
+void SlabCache::unlink(Slab*& list, Slab* slab)
+{
+  if (slab->prev_)
+    slab->prev_->next_ = slab->next_;
+  else
+    list = slab->next_;
+  if (slab->next_)
+    slab->next_->prev_ = slab->prev_;
+  slab->next_ = 0;
+  slab->prev_ = 0;
+}
+
+void SlabCache::printStatistics()
+{
+  MutexLock lock(lock_);
+  size_t capacity = slabs_ * objects_per_slab_;
+  debug(SLAB, "SlabCache %s (%d bytes): %d objects in use (peak %d) of %d in %d slabs of %d pages (%d empty), "
+        "%d allocations, %d passed on for being too big\n", name_, object_size_, objects_in_use_,
+        peak_objects_in_use_, capacity, slabs_, slab_pages_, empty_slabs_, allocations_,
+        fallback_allocations_.load(MEMORY_ORDER_RELAXED));
+}
+
+SlabAllocator* SlabAllocator::instance_ = 0;
+
+SlabAllocator* SlabAllocator::instance()
+{
+  if (unlikely(!instance_))
+    instance_ = new SlabAllocator();
+  return instance_;
+}
+
+SlabAllocator::SlabAllocator() :
+    lock_("SlabAllocator::lock_"), caches_(0)
+{
+}
+
+SlabCache* SlabAllocator::createCache(SlabCache*& cache, const char* name, size_t object_size)
+{
+  MutexLock lock(lock_);
+  // another thread might have been faster
+  if (!cache)
+  {
+    SlabCache* new_cache = new SlabCache(name, object_size);
+    new_cache->next_cache_ = caches_;
+    caches_ = new_cache;
+    cache = new_cache;
+  }
+  return cache;
+}
+
+void SlabAllocator::printStatistics()
+{
+  MutexLock lock(lock_);
+  debug(SLAB, "SlabAllocator::printStatistics:\n");
+  for (SlabCache* cache = caches_; cache; cache = cache->next_cache_)
+    cache->printStatistics();
+}
@@ -2,88 +2,254 @@
 #include "kprintf.h"
 #include "assert.h"
 
-static const uint8 BIT_COUNT[] =
-{
-  0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3,
-  3, 4, 3, 4, 4, 5, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4,
-  3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 1, 2, 2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4,
-  4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 2, 3, 3, 4, 3, 4, 4, 5,
-  3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7, 1, 2,
-  2, 3, 2, 3, 3, 4, 2, 3, 3, 4, 3, 4, 4, 5, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5,
-  4, 5, 5, 6, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5,
-  5, 6, 4, 5, 5, 6, 5, 6, 6, 7, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6,
-  3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5,
-  5, 6, 5, 6, 6, 7, 4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8
-};
+#define FULL_WORD (~(uint64) 0)
+
+const size_t Bitmap::NOT_FOUND;
+
+// there is no popcnt instruction on every target and no libgcc to fall back to
+static size_t countBits(uint64 word)
+{
+  word -= (word >> 1) & 0x5555555555555555ULL;
+  word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+  word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return (size_t) ((word * 0x0101010101010101ULL) >> 56);
+}
+
+// bsf/tzcnt on x86, clz on arm; split, as the 64 bit builtin may need libgcc on 32 bit targets
+static size_t lowestBit(uint64 word)
+{
+  uint32 low = (uint32) word;
+  if (low)
+    return __builtin_ctz(low);
+  return 32 + __builtin_ctz((uint32) (word >> 32));
+}
+
+static uint64 bitsFrom(size_t bit)
+{
+  return FULL_WORD << (bit % BITMAP_WORD_BITS);
+}
 
 Bitmap::Bitmap (size_t number_of_bits)
 {
   size_ = number_of_bits;
   num_bits_set_ = 0;
-  size_t byte_count = number_of_bits / bits_per_bitmap_atom_
-               + ((number_of_bits % bits_per_bitmap_atom_ > 0)?1:0);
-  bitmap_ = new uint8[byte_count];
-  for (size_t byte = 0; byte < byte_count; ++byte)
-    *(bitmap_+byte) = static_cast<uint8>(0);
+
+  num_levels_ = 0;
+  size_t words = 0;
+  size_t level_bits = number_of_bits;
+  do
+  {
+    assert(num_levels_ < BITMAP_MAX_LEVELS);
+    level_words_[num_levels_] = level_bits / BITMAP_WORD_BITS + ((level_bits % BITMAP_WORD_BITS > 0) ? 1 : 0);
+    if (level_words_[num_levels_] == 0)
+      level_words_[num_levels_] = 1;
+    // the summaries exist twice, the bits themselves once
+    words += level_words_[num_levels_] * (num_levels_ ? 2 : 1);
+    level_bits = level_words_[num_levels_];
+    ++num_levels_;
+  } while (level_bits > 1);
+
+  uint64* memory = new uint64[words];
+  full_[0] = non_empty_[0] = memory;
+  memory += level_words_[0];
+  for (size_t level = 1; level < num_levels_; ++level)
+  {
+    full_[level] = memory;
+    memory += level_words_[level];
+    non_empty_[level] = memory;
+    memory += level_words_[level];
+  }
+
+  for (size_t word = 0; word < level_words_[0]; ++word)
+    full_[0][word] = 0;
+  if (size_ % BITMAP_WORD_BITS)
+    full_[0][size_ / BITMAP_WORD_BITS] = bitsFrom(size_);
+  else if (size_ == 0)
+    full_[0][0] = FULL_WORD;
+
+  for (size_t level = 1; level < num_levels_; ++level)
+  {
+    for (size_t word = 0; word < level_words_[level]; ++word)
+    {
+      uint64 full = 0;
+      uint64 non_empty = 0;
+      for (size_t bit = 0; bit < BITMAP_WORD_BITS; ++bit)
+      {
+        size_t below = word * BITMAP_WORD_BITS + bit;
+        if (below >= level_words_[level - 1] || full_[level - 1][below] == FULL_WORD)
+          full |= 1ULL << bit;
+        if (below < level_words_[level - 1] && non_empty_[level - 1][below] != 0)
+          non_empty |= 1ULL << bit;
+      }
+      full_[level][word] = full;
+      non_empty_[level][word] = non_empty;
+    }
+  }
 }
 
 Bitmap::~Bitmap ()
 {
-  delete[] bitmap_;
+  delete[] full_[0];
 }
 
-void Bitmap::setBit(size_t bit_number)
+void Bitmap::changeWord(size_t word_number, uint64 value)
 {
-  assert(bit_number < size_);
-  const size_t byte_number = bit_number / bits_per_bitmap_atom_;
-  const size_t bit_offset = bit_number % bits_per_bitmap_atom_;
-  const uint8 mask = 1 << bit_offset;
-  uint8& byte = bitmap_[byte_number];
+  uint64& word = full_[0][word_number];
+  if (word_number == size_ / BITMAP_WORD_BITS && size_ % BITMAP_WORD_BITS)
+    value |= bitsFrom(size_);
+  uint64 old = word;
+  if (old == value)
+    return;
+  word = value;
 
-  if (!(byte & mask))
+  // the bits past size_ are set in both
+  num_bits_set_ += countBits(value);
+  num_bits_set_ -= countBits(old);
+  if ((old == FULL_WORD) != (value == FULL_WORD))
+    updateSummary(true, word_number, value == FULL_WORD);
+  if ((old != 0) != (value != 0))
+    updateSummary(false, word_number, value != 0);
+}
+
+void Bitmap::updateSummary(bool full, size_t word_number, bool set)
+{
+  uint64** levels = full ? full_ : non_empty_;
+  for (size_t level = 1; level < num_levels_; ++level)
   {
-    byte |= mask;
-    ++num_bits_set_;
+    uint64& word = levels[level][word_number / BITMAP_WORD_BITS];
+    uint64 old = word;
+    uint64 mask = 1ULL << (word_number % BITMAP_WORD_BITS);
+    word = set ? (word | mask) : (word & ~mask);
+    // the level above only changes with the state of the whole word
+    bool was = full ? (old == FULL_WORD) : (old != 0);
+    set = full ? (word == FULL_WORD) : (word != 0);
+    if (was == set)
+      return;
+    word_number /= BITMAP_WORD_BITS;
   }
 }
 
+void Bitmap::setBit(size_t bit_number)
+{
+  assert(bit_number < size_);
+  const size_t word_number = bit_number / BITMAP_WORD_BITS;
+  changeWord(word_number, full_[0][word_number] | (1ULL << (bit_number % BITMAP_WORD_BITS)));
+}
+
 bool Bitmap::getBit(size_t bit_number)
 {
   assert(bit_number < size_);
-  size_t byte_number = bit_number / bits_per_bitmap_atom_;
-  size_t bit_offset = bit_number % bits_per_bitmap_atom_;
-  return (*(bitmap_+byte_number) & (1 << bit_offset));
+  return (full_[0][bit_number / BITMAP_WORD_BITS] >> (bit_number % BITMAP_WORD_BITS)) & 1;
 }
 
 void Bitmap::unsetBit(size_t bit_number)
 {
   assert(bit_number < size_);
-  size_t byte_number = bit_number / bits_per_bitmap_atom_;
-  size_t bit_offset = bit_number % bits_per_bitmap_atom_;
-  const uint8 mask = 1 << bit_offset;
-  uint8& byte = bitmap_[byte_number];
+  const size_t word_number = bit_number / BITMAP_WORD_BITS;
+  changeWord(word_number, full_[0][word_number] & ~(1ULL << (bit_number % BITMAP_WORD_BITS)));
+}
+
+void Bitmap::setRange(size_t bit_number, size_t num)
+{
+  assert(bit_number + num <= size_ && bit_number + num >= bit_number);
+  size_t end = bit_number + num;
+  while (bit_number < end)
+  {
+    size_t word_number = bit_number / BITMAP_WORD_BITS;
+    uint64 mask = bitsFrom(bit_number);
+    if (end - word_number * BITMAP_WORD_BITS < BITMAP_WORD_BITS)
+      mask &= ~bitsFrom(end);
+    changeWord(word_number, full_[0][word_number] | mask);
+    bit_number = (word_number + 1) * BITMAP_WORD_BITS;
+  }
+}
+
+void Bitmap::clearRange(size_t bit_number, size_t num)
+{
+  assert(bit_number + num <= size_ && bit_number + num >= bit_number);
+  size_t end = bit_number + num;
+  while (bit_number < end)
+  {
+    size_t word_number = bit_number / BITMAP_WORD_BITS;
+    uint64 mask = bitsFrom(bit_number);
+    if (end - word_number * BITMAP_WORD_BITS < BITMAP_WORD_BITS)
+      mask &= ~bitsFrom(end);
+    changeWord(word_number, full_[0][word_number] & ~mask);
+    bit_number = (word_number + 1) * BITMAP_WORD_BITS;
+  }
+}
 
-  if (byte & mask)
+size_t Bitmap::find(bool zero, size_t level, size_t from)
+{
+  uint64** levels = zero ? full_ : non_empty_;
+  size_t word_number = from / BITMAP_WORD_BITS;
+  if (word_number >= level_words_[level])
+    return NOT_FOUND;
+  uint64 word = zero ? ~levels[level][word_number] : levels[level][word_number];
+  word &= bitsFrom(from);
+  if (!word)
   {
-    byte &= ~(1 << bit_offset);
-    --num_bits_set_;
+    // the summary above knows the next word with a bit we look for
+    if (level + 1 == num_levels_)
+      return NOT_FOUND;
+    word_number = find(zero, level + 1, word_number + 1);
+    if (word_number == NOT_FOUND)
+      return NOT_FOUND;
+    word = zero ? ~levels[level][word_number] : levels[level][word_number];
+  }
+  return word_number * BITMAP_WORD_BITS + lowestBit(word);
+}
+
+size_t Bitmap::findFirstZero(size_t from)
+{
+  if (from >= size_)
+    return NOT_FOUND;
+  // the bits past size_ are set, they are never found
+  return find(true, 0, from);
+}
+
+size_t Bitmap::findFirstOne(size_t from)
+{
+  if (from >= size_)
+    return NOT_FOUND;
+  size_t bit_number = find(false, 0, from);
+  return bit_number < size_ ? bit_number : NOT_FOUND;
+}
+
+size_t Bitmap::findZeroRun(size_t num, size_t from)
+{
+  while (true)
+  {
+    size_t start = findFirstZero(from);
+    if (start == NOT_FOUND)
+      return NOT_FOUND;
+    size_t end = findFirstOne(start);
+    if (end == NOT_FOUND)
+      end = size_;
+    if (end - start >= num)
+      return start;
+    from = end;
   }
 }
 
 void Bitmap::setByte(size_t byte_number, uint8 byte)
 {
   assert(byte_number*bits_per_bitmap_atom_ < size_);
-  uint8& b = bitmap_[byte_number];
-
-  num_bits_set_ -= BIT_COUNT[b];
-  num_bits_set_ += BIT_COUNT[byte];
-  b = byte;
+  const size_t word_number = byte_number * bits_per_bitmap_atom_ / BITMAP_WORD_BITS;
+  const size_t shift = byte_number * bits_per_bitmap_atom_ % BITMAP_WORD_BITS;
+  uint64 word = full_[0][word_number] & ~(0xFFULL << shift);
+  changeWord(word_number, word | ((uint64) byte << shift));
 }
 
 uint8 Bitmap::getByte(size_t byte_number)
 {
   assert(byte_number*bits_per_bitmap_atom_ < size_);
-  return bitmap_[byte_number];
+  uint64 word = full_[0][byte_number * bits_per_bitmap_atom_ / BITMAP_WORD_BITS];
+  uint8 byte = (uint8) (word >> (byte_number * bits_per_bitmap_atom_ % BITMAP_WORD_BITS));
+  // the bits past size_ are not part of the bitmap
+  if ((byte_number + 1) * bits_per_bitmap_atom_ > size_)
+    byte &= (uint8) ((1U << (size_ % bits_per_bitmap_atom_)) - 1);
+  return byte;
 }
 
 void Bitmap::bmprint()
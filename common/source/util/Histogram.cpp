@@ -0,0 +1,41 @@
+#include "Histogram.h"
+#include "kprintf.h"
+
+Histogram::Histogram() :
+    count_(0), sum_(0), max_(0)
+{
+  for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i)
+    buckets_[i] = 0;
+}
+
+void Histogram::add(uint64 value)
+{
+  // the number of significant bits, split up to keep the 32 bit builds free of 64 bit builtins
+  uint32 high = value >> 32;
+  uint32 low = value;
+  size_t bucket = high ? 64 - __builtin_clz(high) : (low ? 32 - __builtin_clz(low) : 0);
+  if (bucket >= HISTOGRAM_BUCKETS)
+    bucket = HISTOGRAM_BUCKETS - 1;
+  ++buckets_[bucket];
+  ++count_;
+  sum_ += value;
+  if (value > max_)
+    max_ = value;
+}
+
+void Histogram::print(const char* name, const char* unit) const
+{
+  kprintfd("  %s: %d samples, average %d %s, max %d %s\n", name, (size_t) count_, (size_t) getAverage(), unit,
+           (size_t) max_, unit);
+  for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i)
+  {
+    if (!buckets_[i])
+      continue;
+    if (i == 0)
+      kprintfd("    == 0: %d\n", buckets_[i]);
+    else if (i == HISTOGRAM_BUCKETS - 1)
+      kprintfd("    >= 2^%d: %d\n", i - 1, buckets_[i]);
+    else
+      kprintfd("    <  2^%d: %d\n", i, buckets_[i]);
+  }
+}
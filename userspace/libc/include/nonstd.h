@@ -17,6 +17,20 @@ extern "C" {
  */ 
 extern int createprocess(const char* path, int sleep);
 
+/**
+ * Waits on or wakes up a futex, used to build the pthread and semaphore functions.
+ * The futex is the 32 bit word at address, it is changed with atomic instructions in userspace
+ * and the kernel is only called when threads have to sleep or there might be sleeping threads.
+ *
+ * @param address the 4 byte aligned word
+ * @param op FUTEX_WAIT: sleep as long as the word holds value, until woken up by FUTEX_WAKE
+ *           FUTEX_WAKE: wake up at most value threads sleeping on the word
+ * @param value see op
+ * @return FUTEX_WAIT: 0 if woken up, -1 if the word did not hold value
+ *         FUTEX_WAKE: the number of threads woken up
+ */
+extern int futex(unsigned int* address, int op, unsigned int value);
+
 #ifdef __cplusplus
 }
 #endif
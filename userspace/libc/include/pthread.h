@@ -11,16 +11,23 @@ typedef unsigned int pthread_t;
 typedef unsigned int pthread_attr_t;
 
 //pthread mutex typedefs
+//0: unlocked, 1: locked, 2: locked and there might be threads waiting
 typedef unsigned int pthread_mutex_t;
 typedef unsigned int pthread_mutexattr_t;
+#define PTHREAD_MUTEX_INITIALIZER 0
 
 //pthread spinlock typedefs
 #define PTHREAD_SPINLOCK_T_DEFINED
 typedef unsigned int pthread_spinlock_t;
 
 //pthread cond typedefs
-typedef unsigned int pthread_cond_t;
+typedef struct
+{
+  unsigned int sequence; //incremented by every signal, waiters sleep on it
+  unsigned int waiters;
+} pthread_cond_t;
 typedef unsigned int pthread_condattr_t;
+#define PTHREAD_COND_INITIALIZER { 0, 0 }
 
 extern int pthread_create(pthread_t *thread,
          const pthread_attr_t *attr, void *(*start_routine)(void *),
@@ -42,6 +49,8 @@ extern int pthread_mutex_destroy(pthread_mutex_t *mutex);
 
 extern int pthread_mutex_lock(pthread_mutex_t *mutex);
 
+extern int pthread_mutex_trylock(pthread_mutex_t *mutex);
+
 extern int pthread_mutex_unlock(pthread_mutex_t *mutex);
 
 extern int pthread_cond_init(pthread_cond_t *cond, const pthread_condattr_t *attr);
@@ -54,6 +63,16 @@ extern int pthread_cond_broadcast(pthread_cond_t *cond);
 
 extern int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex);
 
+extern int pthread_spin_init(pthread_spinlock_t *lock, int pshared);
+
+extern int pthread_spin_destroy(pthread_spinlock_t *lock);
+
+extern int pthread_spin_lock(pthread_spinlock_t *lock);
+
+extern int pthread_spin_trylock(pthread_spinlock_t *lock);
+
+extern int pthread_spin_unlock(pthread_spinlock_t *lock);
+
 #ifdef __cplusplus
 }
 #endif
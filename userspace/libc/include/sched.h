@@ -6,9 +6,39 @@ extern "C" {
 #endif
 
 #include "../../../common/include/kernel/syscall-definitions.h"
+#include "types.h"
+
+struct sched_param
+{
+  int sched_priority;
+};
 
 extern int sched_yield(void);
 
+/**
+ * changes the scheduling policy of the calling thread
+ * SCHED_FIFO and SCHED_RR threads run before all SCHED_OTHER threads (both are round robin
+ * within a priority level), as long as the real-time threads leave a part of the CPU time
+ * to the others
+ * @param pid has to be 0 (the calling thread)
+ * @param policy SCHED_OTHER, SCHED_FIFO or SCHED_RR
+ * @param param the priority, see sched_get_priority_min() and sched_get_priority_max()
+ * @return 0 on success, -1 otherwise
+ */
+extern int sched_setscheduler(pid_t pid, int policy, const struct sched_param *param);
+
+extern int sched_get_priority_min(int policy);
+
+extern int sched_get_priority_max(int policy);
+
+/**
+ * makes the calling thread a SCHED_DEADLINE thread, it gets runtime_ms of CPU time
+ * in every period of period_ms milliseconds (earliest deadline first)
+ * this is not posix, linux has sched_setattr() instead
+ * @return 0 on success, -1 if the parameters are invalid or the system cannot guarantee the CPU time
+ */
+extern int sched_setdeadline(unsigned int runtime_ms, unsigned int period_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,7 +8,11 @@ extern "C" {
 //semaphores typedefs
 #ifndef SEM_T_DEFINED_
 #define SEM_T_DEFINED_
-typedef unsigned int sem_t;
+typedef struct
+{
+  unsigned int value; //waiters sleep on it while it is 0
+  unsigned int waiters;
+} sem_t;
 #endif // SEM_T_DEFINED_
 
 extern int sem_init(sem_t *sem, int pshared, unsigned value);
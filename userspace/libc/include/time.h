@@ -12,8 +12,28 @@ extern "C" {
 typedef unsigned int clock_t;
 #endif // CLOCK_T_DEFINED
 
+#ifndef TIME_T_DEFINED
+#define TIME_T_DEFINED
+typedef long int time_t;
+#endif // TIME_T_DEFINED
+
+struct timespec
+{
+  time_t tv_sec;
+  long tv_nsec;
+};
+
 extern clock_t clock(void);
 
+/**
+ * suspends the calling thread for (at least) the time given in req
+ * the time is rounded up to whole timer ticks of the kernel
+ * @param req the time to sleep, tv_nsec has to be in the range 0 to 999999999
+ * @param rem receives the remaining time in case the sleep is interrupted (always 0 at the moment), may be 0
+ * @return 0 on success, -1 if req is invalid
+ */
+extern int nanosleep(const struct timespec *req, struct timespec *rem);
+
 #ifdef __cplusplus
 }
 #endif
@@ -289,6 +289,14 @@ extern void* sbrk(intptr_t increment);
 
 extern unsigned int sleep(unsigned int seconds);
 
+/**
+ * adds inc to the nice value of the calling thread
+ * a higher nice value means a smaller share of the CPU time
+ * @param inc the increment, may be negative
+ * @return the new nice value (-20 to 19)
+ */
+extern int nice(int inc);
+
 /**
  * Replaces the current process image with a new one.
  * The values provided with the argv array are the arguments for the new
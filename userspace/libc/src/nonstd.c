@@ -8,6 +8,11 @@ int createprocess(const char* path, int sleep)
   return __syscall(sc_createprocess, (long) path, sleep, 0x00, 0x00, 0x00);
 }
 
+int futex(unsigned int* address, int op, unsigned int value)
+{
+  return __syscall(sc_futex, (size_t) address, op, value, 0x00, 0x00);
+}
+
 extern int main();
 
 void _start()
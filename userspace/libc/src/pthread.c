@@ -1,24 +1,23 @@
 #include "pthread.h"
+#include "nonstd.h"
+#include "sched.h"
 
 /**
- * function stub
- * posix compatible signature - do not change the signature!
+ * number of times pthread_spin_lock() tries to get the lock before giving up the CPU
  */
-int pthread_create(pthread_t *thread, const pthread_attr_t *attr,
-                   void *(*start_routine)(void *), void *arg)
-{
-  return -1;
-}
+#define SPIN_YIELD_ITERATIONS 100
 
 /**
  * function stub
  * posix compatible signature - do not change the signature!
  */
-int pthread_mutex_init(pthread_mutex_t *mutex, const pthread_mutexattr_t *attr)
+int pthread_create(pthread_t *thread, const pthread_attr_t *attr,
+                   void *(*start_routine)(void *), void *arg)
 {
   return -1;
 }
 
+
 /**
  * function stub
  * posix compatible signature - do not change the signature!
@@ -55,119 +54,169 @@ int pthread_detach(pthread_t thread)
 }
 
 /**
- * function stub
+ * posix compatible signature - do not change the signature!
+ */
+int pthread_mutex_init(pthread_mutex_t *mutex, const pthread_mutexattr_t *attr)
+{
+  *mutex = 0;
+  return 0;
+}
+
+/**
  * posix compatible signature - do not change the signature!
  */
 int pthread_mutex_destroy(pthread_mutex_t *mutex)
 {
-  return -1;
+  return *mutex ? -1 : 0;
+}
+
+/**
+ * locks the mutex with the state 2, so the thread unlocking it wakes up the next waiter
+ */
+static void mutex_lock_contended(pthread_mutex_t *mutex)
+{
+  while (__sync_lock_test_and_set(mutex, 2) != 0)
+    futex(mutex, FUTEX_WAIT, 2);
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int pthread_mutex_lock(pthread_mutex_t *mutex)
 {
-  return -1;
+  // uncontended case: 0 -> 1 without calling the kernel
+  if (__sync_val_compare_and_swap(mutex, 0, 1) != 0)
+    mutex_lock_contended(mutex);
+  return 0;
+}
+
+/**
+ * posix compatible signature - do not change the signature!
+ */
+int pthread_mutex_trylock(pthread_mutex_t *mutex)
+{
+  return __sync_val_compare_and_swap(mutex, 0, 1) == 0 ? 0 : -1;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int pthread_mutex_unlock(pthread_mutex_t *mutex)
 {
-  return -1;
+  // only a mutex which was in state 2 might have sleeping threads
+  if (__sync_fetch_and_sub(mutex, 1) != 1)
+  {
+    *(volatile pthread_mutex_t*) mutex = 0;
+    futex(mutex, FUTEX_WAKE, 1);
+  }
+  return 0;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int pthread_cond_init(pthread_cond_t *cond, const pthread_condattr_t *attr)
 {
-  return -1;
+  cond->sequence = 0;
+  cond->waiters = 0;
+  return 0;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int pthread_cond_destroy(pthread_cond_t *cond)
 {
-  return -1;
+  return cond->waiters ? -1 : 0;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int pthread_cond_signal(pthread_cond_t *cond)
 {
-  return -1;
+  __sync_fetch_and_add(&cond->sequence, 1);
+  if (*(volatile unsigned int*) &cond->waiters)
+    futex(&cond->sequence, FUTEX_WAKE, 1);
+  return 0;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int pthread_cond_broadcast(pthread_cond_t *cond)
 {
-  return -1;
+  __sync_fetch_and_add(&cond->sequence, 1);
+  if (*(volatile unsigned int*) &cond->waiters)
+    futex(&cond->sequence, FUTEX_WAKE, -1U);
+  return 0;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
 {
-  return -1;
+  // the waiter is counted while holding the mutex, a signal after releasing it sees it
+  __sync_fetch_and_add(&cond->waiters, 1);
+  unsigned int sequence = *(volatile unsigned int*) &cond->sequence;
+  pthread_mutex_unlock(mutex);
+  // returns right away if there was a signal since reading the sequence
+  futex(&cond->sequence, FUTEX_WAIT, sequence);
+  __sync_fetch_and_sub(&cond->waiters, 1);
+  // other threads woken up by a broadcast might wait for the mutex, unlocking has to wake them up
+  mutex_lock_contended(mutex);
+  return 0;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
-int pthread_spin_destroy(pthread_spinlock_t *lock)
+int pthread_spin_init(pthread_spinlock_t *lock, int pshared)
 {
-  return -1;
+  *lock = 0;
+  return 0;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
-int pthread_spin_init(pthread_spinlock_t *lock, int pshared)
+int pthread_spin_destroy(pthread_spinlock_t *lock)
 {
-  return -1;
+  return *lock ? -1 : 0;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int pthread_spin_lock(pthread_spinlock_t *lock)
 {
-  return -1;
+  unsigned int iterations = 0;
+  while (__sync_lock_test_and_set(lock, 1))
+  {
+    // spin reading only, the holder might run on another cpu
+    while (*(volatile pthread_spinlock_t*) lock)
+    {
+      if (++iterations % SPIN_YIELD_ITERATIONS == 0)
+        sched_yield();
+    }
+  }
+  return 0;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int pthread_spin_trylock(pthread_spinlock_t *lock)
 {
-  return -1;
+  return __sync_lock_test_and_set(lock, 1) ? -1 : 0;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int pthread_spin_unlock(pthread_spinlock_t *lock)
 {
-  return -1;
+  __sync_lock_release(lock);
+  return 0;
 }
-
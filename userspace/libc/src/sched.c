@@ -10,3 +10,35 @@ int sched_yield(void)
 {
   return __syscall(sc_sched_yield, 0x00, 0x00, 0x00, 0x00, 0x00);
 }
+
+/**
+ * posix compatible signature - do not change the signature!
+ */
+int sched_setscheduler(pid_t pid, int policy, const struct sched_param *param)
+{
+  if (pid != 0 || !param)
+    return -1;
+  return __syscall(sc_sched_setscheduler, policy, param->sched_priority, 0x00, 0x00, 0x00);
+}
+
+/**
+ * posix compatible signature - do not change the signature!
+ */
+int sched_get_priority_min(int policy)
+{
+  return (policy == SCHED_FIFO || policy == SCHED_RR) ? 1 : 0;
+}
+
+/**
+ * posix compatible signature - do not change the signature!
+ */
+int sched_get_priority_max(int policy)
+{
+  // the highest of the kernel's 32 real-time levels is reserved for kernel workers
+  return (policy == SCHED_FIFO || policy == SCHED_RR) ? 31 : 0;
+}
+
+int sched_setdeadline(unsigned int runtime_ms, unsigned int period_ms)
+{
+  return __syscall(sc_sched_setscheduler, SCHED_DEADLINE, 0x00, runtime_ms, period_ms, 0x00);
+}
@@ -1,49 +1,63 @@
 #include "semaphore.h"
+#include "nonstd.h"
 
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int sem_wait(sem_t *sem)
 {
-  return -1;
+  while (sem_trywait(sem) != 0)
+  {
+    // the waiter is counted before sleeping, sem_post() only calls the kernel if there are waiters
+    __sync_fetch_and_add(&sem->waiters, 1);
+    futex(&sem->value, FUTEX_WAIT, 0);
+    __sync_fetch_and_sub(&sem->waiters, 1);
+  }
+  return 0;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int sem_trywait(sem_t *sem)
 {
+  unsigned int value;
+  while ((value = *(volatile unsigned int*) &sem->value) > 0)
+  {
+    if (__sync_val_compare_and_swap(&sem->value, value, value - 1) == value)
+      return 0;
+  }
   return -1;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int sem_init(sem_t *sem, int pshared, unsigned value)
 {
-  return -1;
+  sem->value = value;
+  sem->waiters = 0;
+  return 0;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int sem_destroy(sem_t *sem)
 {
-  return -1;
+  return sem->waiters ? -1 : 0;
 }
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 int sem_post(sem_t *sem)
 {
-  return -1;
+  __sync_fetch_and_add(&sem->value, 1);
+  if (*(volatile unsigned int*) &sem->waiters)
+    futex(&sem->value, FUTEX_WAKE, 1);
+  return 0;
 }
 
 
@@ -1,4 +1,6 @@
 #include "time.h"
+#include "sys/syscall.h"
+#include "../../../common/include/kernel/syscall-definitions.h"
 
 
 /**
@@ -9,3 +11,11 @@ clock_t clock(void)
 {
   return (clock_t) -1U;
 }
+
+/**
+ * posix compatible signature - do not change the signature!
+ */
+int nanosleep(const struct timespec *req, struct timespec *rem)
+{
+  return __syscall(sc_nanosleep, (long) req, (long) rem, 0x00, 0x00, 0x00);
+}
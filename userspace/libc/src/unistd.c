@@ -1,4 +1,7 @@
 #include "unistd.h"
+#include "time.h"
+#include "sys/syscall.h"
+#include "../../../common/include/kernel/syscall-definitions.h"
 
 
 /**
@@ -21,13 +24,20 @@ void* sbrk(intptr_t increment)
 
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
  */
 unsigned int sleep(unsigned int seconds)
 {
-  return -1U;
+  struct timespec request = { seconds, 0 };
+  if (nanosleep(&request, 0) != 0)
+    return seconds;
+  return 0;
 }
 
-
-
+/**
+ * posix compatible signature - do not change the signature!
+ */
+int nice(int inc)
+{
+  return __syscall(sc_nice, inc, 0x00, 0x00, 0x00, 0x00);
+}
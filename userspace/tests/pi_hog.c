@@ -0,0 +1,55 @@
+#include "stdio.h"
+#include "sched.h"
+#include "time.h"
+
+/**
+ * the medium priority thread of pi_test: wakes up periodically and keeps the CPU for a while,
+ * without using any lock
+ */
+
+#define BURSTS 100
+#define BURST_CYCLES 50000000ULL
+
+#if defined(__x86_64__) || defined(__i386__)
+
+typedef unsigned long long uint64;
+
+static uint64 rdtsc()
+{
+  unsigned int low, high;
+  asm volatile("rdtsc" : "=a"(low), "=d"(high));
+  return ((uint64) high << 32) | low;
+}
+
+int main()
+{
+  struct sched_param param;
+  param.sched_priority = 15;
+  if (sched_setscheduler(0, SCHED_FIFO, &param))
+  {
+    printf("pi_hog: could not switch to SCHED_FIFO\n");
+    return -1;
+  }
+  printf("pi_hog: %u bursts of %u cycles\n", BURSTS, (unsigned int) BURST_CYCLES);
+
+  struct timespec pause = { 0, 7000000 };
+  int i;
+  for (i = 0; i < BURSTS; ++i)
+  {
+    nanosleep(&pause, 0);
+    uint64 start = rdtsc();
+    while (rdtsc() - start < BURST_CYCLES)
+      ;
+  }
+  return 0;
+}
+
+#else
+
+int main()
+{
+  printf("pi_hog: no cycle counter on this architecture\n");
+  return 0;
+}
+
+#endif
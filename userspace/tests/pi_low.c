@@ -0,0 +1,29 @@
+#include "stdio.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "sched.h"
+
+/**
+ * the low priority thread of pi_test: holds open_files_lock as often as possible
+ */
+
+#define ITERATIONS 200000
+
+int main()
+{
+  struct sched_param param;
+  param.sched_priority = 1;
+  if (sched_setscheduler(0, SCHED_FIFO, &param))
+  {
+    printf("pi_low: could not switch to SCHED_FIFO\n");
+    return -1;
+  }
+  int i;
+  for (i = 0; i < ITERATIONS; ++i)
+  {
+    int fd = open("/usr/pi_low.sweb", O_RDONLY);
+    if (fd >= 0)
+      close(fd);
+  }
+  return 0;
+}
@@ -0,0 +1,76 @@
+#include "stdio.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "sched.h"
+#include "time.h"
+#include "nonstd.h"
+
+/**
+ * shows the priority inversion on a kernel Mutex (open_files_lock, taken by every open and close):
+ * pi_low.sweb (SCHED_FIFO 1) opens and closes a file all the time, pi_hog.sweb (SCHED_FIFO 15)
+ * wakes up periodically and burns the CPU for a while. In case the hog preempts pi_low while it
+ * holds the mutex, this thread (SCHED_FIFO 30) has to wait in open() until the hog is done,
+ * unless pi_low inherits its priority and releases the mutex right away.
+ * The maximum latency of open() gets close to the burst length of the hog without priority inheritance.
+ */
+
+#define ROUNDS 400
+
+#if defined(__x86_64__) || defined(__i386__)
+
+typedef unsigned long long uint64;
+
+static uint64 rdtsc()
+{
+  unsigned int low, high;
+  asm volatile("rdtsc" : "=a"(low), "=d"(high));
+  return ((uint64) high << 32) | low;
+}
+
+int main()
+{
+  struct sched_param param;
+  param.sched_priority = 30;
+  if (sched_setscheduler(0, SCHED_FIFO, &param))
+  {
+    printf("pi_test: could not switch to SCHED_FIFO\n");
+    return -1;
+  }
+  if (createprocess("/usr/pi_low.sweb", 0) || createprocess("/usr/pi_hog.sweb", 0))
+  {
+    printf("pi_test: could not start pi_low.sweb and pi_hog.sweb\n");
+    return -1;
+  }
+
+  struct timespec pause = { 0, 5000000 };
+  uint64 max_cycles = 0;
+  uint64 total_cycles = 0;
+  int i;
+  for (i = 0; i < ROUNDS; ++i)
+  {
+    nanosleep(&pause, 0);
+    uint64 start = rdtsc();
+    int fd = open("/usr/pi_test.sweb", O_RDONLY);
+    uint64 cycles = rdtsc() - start;
+    if (fd >= 0)
+      close(fd);
+    total_cycles += cycles;
+    if (cycles > max_cycles)
+      max_cycles = cycles;
+  }
+
+  printf("pi_test: open() latency of the SCHED_FIFO 30 thread over %u rounds:\n", ROUNDS);
+  printf("  average: %u cycles\n", (unsigned int) (total_cycles / ROUNDS));
+  printf("  maximum: %u cycles (compare with the burst length printed by pi_hog)\n", (unsigned int) max_cycles);
+  return 0;
+}
+
+#else
+
+int main()
+{
+  printf("pi_test: no cycle counter on this architecture\n");
+  return 0;
+}
+
+#endif
@@ -0,0 +1,68 @@
+#include "stdio.h"
+#include "sys/syscall.h"
+#include "../../common/include/kernel/syscall-definitions.h"
+
+/**
+ * measures the round trip time of a syscall which does (almost) nothing in the kernel:
+ * nice(0) through the libc stub (SYSCALL on x86_64, SYSENTER on x86/32) and through int 0x80
+ */
+
+#define ITERATIONS 10000
+
+#if defined(__x86_64__) || defined(__i386__)
+
+typedef unsigned long long uint64;
+
+static uint64 rdtsc()
+{
+  unsigned int low, high;
+  asm volatile("rdtsc" : "=a"(low), "=d"(high));
+  return ((uint64) high << 32) | low;
+}
+
+static size_t interruptSyscall(size_t number, size_t arg)
+{
+  size_t result;
+#ifdef __x86_64__
+  asm volatile("int $0x80" : "=a"(result) : "D"(number), "S"(arg), "d"(0), "c"(0) : "r8", "r9", "memory");
+#else
+  asm volatile("int $0x80" : "=a"(result) : "a"(number), "b"(arg), "c"(0), "d"(0), "S"(0), "D"(0) : "memory");
+#endif
+  return result;
+}
+
+static unsigned int measure(int use_interrupt)
+{
+  uint64 start = rdtsc();
+  int i;
+  for (i = 0; i < ITERATIONS; ++i)
+  {
+    if (use_interrupt)
+      interruptSyscall(sc_nice, 0);
+    else
+      __syscall(sc_nice, 0, 0, 0, 0, 0);
+  }
+  return (unsigned int) ((rdtsc() - start) / ITERATIONS);
+}
+
+int main()
+{
+  // warm up caches and TLB
+  measure(0);
+  measure(1);
+
+  printf("syscall round trip, average of %u calls:\n", ITERATIONS);
+  printf("  libc stub (fast entry): %u cycles\n", measure(0));
+  printf("  int 0x80:               %u cycles\n", measure(1));
+  return 0;
+}
+
+#else
+
+int main()
+{
+  printf("syscallbench: no cycle counter on this architecture\n");
+  return 0;
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef _ARCH_ATOMIC_H_
+#define _ARCH_ATOMIC_H_
+
+// exe2minixfs is single threaded host code, the operations only have to compile
+
+class ArchAtomic
+{
+  public:
+    template<typename T>
+    static T load(const T& value, MemoryOrder)
+    {
+      return value;
+    }
+
+    template<typename T>
+    static void store(T& target, T value, MemoryOrder)
+    {
+      target = value;
+    }
+
+    template<typename T>
+    static T exchange(T& target, T value, MemoryOrder)
+    {
+      T result = target;
+      target = value;
+      return result;
+    }
+
+    template<typename T>
+    static bool compareExchange(T& target, T& expected, T desired, MemoryOrder)
+    {
+      if (target != expected)
+      {
+        expected = target;
+        return false;
+      }
+      target = desired;
+      return true;
+    }
+
+    template<typename T>
+    static T fetchAdd(T& target, T increment, MemoryOrder)
+    {
+      T result = target;
+      target += increment;
+      return result;
+    }
+};
+
+#endif
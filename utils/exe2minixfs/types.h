@@ -5,7 +5,10 @@
 
 #define Mutex const char*
 #define MutexLock __attribute__((unused)) const char*
-#define ArchThreads
+#define RWLock const char*
+#define ScopedReadLock __attribute__((unused)) const char*
+#define ScopedWriteLock __attribute__((unused)) const char*
+#define RCUReadLock __attribute__((unused)) const char*
 
 #include <stdint.h>
 #include <string.h>
@@ -37,7 +40,5 @@ class FakeThread { public: FileSystemInfo* getWorkingDirInfo() { return 0; } };
 
 extern FakeThread* currentThread;
 
-size_t atomic_add(size_t& x,size_t y);
-
 #endif
 #endif